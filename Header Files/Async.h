@@ -0,0 +1,268 @@
+#pragma once
+
+#ifndef ASYNC_H_INCLUDED
+#define ASYNC_H_INCLUDED
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "Builder.h"
+#include "ThreadPool.h"
+
+// shared flag an async operation polls to stop early, copies refer to the same flag
+class CancellationToken {
+public:
+	CancellationToken() : _flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+	// ask the operations holding a copy to stop
+	void cancel() const { _flag->store(true); }
+
+	// true after cancel() was called on any copy
+	bool cancelled() const { return _flag->load(); }
+private:
+	std::shared_ptr<std::atomic<bool>> _flag;
+};
+
+// thrown from co_await when the operation was stopped by its CancellationToken
+class OperationCancelled : public Exception {
+public:
+	using Exception::Exception;
+};
+
+namespace detail {
+
+// event a blocked syncWait caller sleeps on, the finished task signals it
+struct TaskEvent {
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _done{};
+
+	void set() {
+		std::lock_guard lock(_mutex);
+		_done = true;
+		_cv.notify_all();
+	}
+
+	void wait() {
+		std::unique_lock lock(_mutex);
+		_cv.wait(lock, [this] { return _done; });
+	}
+};
+
+// part of the promise shared by Task<T> and Task<void>
+struct TaskPromiseBase {
+	// the coroutine resumes the one awaiting it (or wakes syncWait) when it finishes
+	struct FinalAwaiter {
+		bool await_ready() const noexcept { return false; }
+
+		template <class Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+			TaskPromiseBase& promise = handle.promise();
+			std::coroutine_handle<> continuation = promise._continuation;
+
+			// the frame may be destroyed as soon as the event is set, nothing is read from it afterwards
+			if (promise._event) promise._event->set();
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept {}
+	};
+
+	// tasks are lazy, they start when they are awaited
+	std::suspend_always initial_suspend() const noexcept { return {}; }
+
+	FinalAwaiter final_suspend() const noexcept { return {}; }
+
+	void unhandled_exception() { _error = std::current_exception(); }
+
+	void rethrow() const {
+		if (_error) std::rethrow_exception(_error);
+	}
+
+	std::coroutine_handle<> _continuation;
+	TaskEvent* _event = nullptr;
+	std::exception_ptr _error;
+};
+
+} // namespace detail
+
+// lazy coroutine producing a T: it starts when it is co_awaited (or given to syncWait)
+// and resumes its awaiter on the thread it finishes on, exceptions reach the awaiter
+template <class T = void>
+class Task {
+public:
+	struct promise_type : detail::TaskPromiseBase {
+		Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+		template <class Value>
+		void return_value(Value&& value) { _value.emplace(std::forward<Value>(value)); }
+
+		T take() {
+			rethrow();
+			return std::move(*_value);
+		}
+
+		std::optional<T> _value;
+	};
+
+	Task(Task&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+
+	Task& operator = (Task&& other) noexcept {
+		std::swap(_handle, other._handle);
+		return *this;
+	}
+
+	~Task() {
+		if (_handle) _handle.destroy();
+	}
+
+	// awaiting starts the task, the awaiter is resumed with its result
+	auto operator co_await() && noexcept {
+		struct Awaiter {
+			std::coroutine_handle<promise_type> _handle;
+
+			bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+				_handle.promise()._continuation = awaiting;
+				return _handle;
+			}
+
+			T await_resume() { return _handle.promise().take(); }
+		};
+		return Awaiter{ _handle };
+	}
+
+	// start the task and block until it has finished (for code outside of coroutines)
+	T syncWait() && {
+		detail::TaskEvent event;
+		_handle.promise()._event = &event;
+		_handle.resume();
+		event.wait();
+		return _handle.promise().take();
+	}
+private:
+	explicit Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+	std::coroutine_handle<promise_type> _handle;
+};
+
+// Task without a result
+template <>
+class Task<void> {
+public:
+	struct promise_type : detail::TaskPromiseBase {
+		Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+		void return_void() {}
+
+		void take() { rethrow(); }
+	};
+
+	Task(Task&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+
+	Task& operator = (Task&& other) noexcept {
+		std::swap(_handle, other._handle);
+		return *this;
+	}
+
+	~Task() {
+		if (_handle) _handle.destroy();
+	}
+
+	// awaiting starts the task, the awaiter is resumed when it has finished
+	auto operator co_await() && noexcept {
+		struct Awaiter {
+			std::coroutine_handle<promise_type> _handle;
+
+			bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+				_handle.promise()._continuation = awaiting;
+				return _handle;
+			}
+
+			void await_resume() { _handle.promise().take(); }
+		};
+		return Awaiter{ _handle };
+	}
+
+	// start the task and block until it has finished (for code outside of coroutines)
+	void syncWait() && {
+		detail::TaskEvent event;
+		_handle.promise()._event = &event;
+		_handle.resume();
+		event.wait();
+		_handle.promise().take();
+	}
+private:
+	explicit Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+	std::coroutine_handle<promise_type> _handle;
+};
+
+// co_await resumeOn(executor) continues the coroutine as a task of the executor,
+// anything with submit(std::function<void()>) works (a ThreadPool or an event loop adapter)
+template <class Executor>
+auto resumeOn(Executor& executor) {
+	struct Awaiter {
+		Executor& _executor;
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle) {
+			_executor.submit([handle] { handle.resume(); });
+		}
+
+		void await_resume() const noexcept {}
+	};
+	return Awaiter{ executor };
+}
+
+// parts of the statistics computed by computeStatsAsync
+enum class StatsMask : unsigned {
+	Areas = 1,   // elements by material / surface area id
+	Nodes = 2,   // node use in elements
+	Common = 4,  // most common node of the elements
+	Quality = 8, // element quality by material
+	All = 15
+};
+
+inline StatsMask operator | (StatsMask lhs, StatsMask rhs) {
+	return static_cast<StatsMask>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+}
+
+// true if the mask has every part of another one
+inline bool contains(StatsMask mask, StatsMask part) {
+	return (static_cast<unsigned>(mask) & static_cast<unsigned>(part)) == static_cast<unsigned>(part);
+}
+
+// position of a running computeStatsAsync, reported after every part
+struct StatsProgress {
+	size_t _elements{};      // finite and boundary elements processed so far (over all parts)
+	size_t _totalElements{}; // finite and boundary elements of all of the parts
+};
+
+// (GCC 12 destroys class prvalues passed to these calls inside a co_await expression twice,
+// named arguments avoid it there)
+
+// load a *.neu or *.aneu file (also .gz / .zst) on a worker of the pool,
+// progress is called on that worker, the token is checked every few thousand lines
+// (OperationCancelled), the awaiter is resumed on the worker
+Task<std::unique_ptr<AneuMeshLoader>> loadMeshAsync(std::string,
+						    LoadOptions = {},
+						    CancellationToken = {},
+						    std::function<void(const LoadProgress&)> = {},
+						    ThreadPool& = ThreadPool::shared());
+
+// statistics of a mesh on a worker of the pool (the mesh must not change until the task finishes),
+// progress is called on that worker and the token is checked between the parts
+Task<std::shared_ptr<Statistics>> computeStatsAsync(const AneuMeshLoader&,
+						    StatsMask = StatsMask::All,
+						    CancellationToken = {},
+						    std::function<void(const StatsProgress&)> = {},
+						    ThreadPool& = ThreadPool::shared());
+
+#endif
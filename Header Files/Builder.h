@@ -1,6 +1,38 @@
 #pragma once
 
 #include "Mesh.h"
+#include "ThreadPool.h"
+
+// mesh quality of the finite elements with one material area id (triangles, quadrilaterals,
+// tetrahedra, pyramids, prisms and hexahedra of the space dimension, also with midside nodes)
+class QualityStats {
+public:
+    // amount of measured elements
+    size_t _elements = 0;
+
+    // aspect ratio normalized to 1 for the equilateral triangle / regular tetrahedron,
+    // longest over shortest edge for the other shapes
+    double _minAspectRatio = std::numeric_limits<double>::max();
+    double _maxAspectRatio = 0;
+
+    // dihedral angles of tetrahedra, interior angles of triangles and quadrilaterals,
+    // corner angles of the faces of the other 3D shapes (degrees)
+    double _minAngle = 180;
+    double _maxAngle = 0;
+
+    // edge lengths
+    double _minEdge = std::numeric_limits<double>::max();
+    double _maxEdge = 0;
+
+    // edge length histogram, bins split [Statistics::_edgeHistogramMin, _edgeHistogramMax] evenly
+    std::vector<size_t> _edgeHistogram;
+
+    // elements with (almost) zero area/volume
+    size_t _degenerate = 0;
+
+    // elements oriented against the majority of the mesh
+    size_t _inverted = 0;
+};
 
 class Statistics {
 public:
@@ -52,8 +84,23 @@ public:
     bool _commonNodeBEIsInitialized = false;
 
 
+    // mesh quality per material area id
+    // (e.g. map[material area id] = quality)
+    std::unordered_map<size_t, QualityStats> _qualityFEareaId;
+
+    // range of the edge length histograms
+    double _edgeHistogramMin = 0;
+    double _edgeHistogramMax = 0;
+
+    // helper flag for ShowData method
+    bool _qualityIsInitialized = false;
+
+
     // display data
     void ShowData() const;
+
+    // write the loaded statistics as one JSON object (ids sorted, parts not loaded are left out)
+    void WriteJson(std::ostream&) const;
 };
 
 // abstract builder class for loading data from file
@@ -63,11 +110,14 @@ public:
     virtual ~GatherDataBuilder() {}
 
     // fill data
-    virtual void load(const std::string&) const = 0;
+    virtual void load(const std::string&) = 0;
 
-    // getter
+    // getter (shared ownership)
     virtual std::shared_ptr<AneuMeshLoader> GetObject() = 0;
 
+    // hand over the loaded mesh and start a new one
+    virtual std::unique_ptr<AneuMeshLoader> Release() = 0;
+
     // reset field
     virtual void Reset() = 0;
 };
@@ -76,53 +126,87 @@ public:
 class GatherDataBuilderNeu : public GatherDataBuilder {
 public:
     // constructor
-    GatherDataBuilderNeu() { Reset(); }
+    explicit GatherDataBuilderNeu(const ReaderOptions& options = {}, 
+                                  const LoadOptions&   loadOptions = {}) : _options(options), _loadOptions(loadOptions) { Reset(); }
 
     // destructor
     // ~GatherDataBuilderNeu() { delete _data; }
 
     // reset field
-    void Reset() override { _data.reset(new AneuMeshLoader()); }
+    void Reset() override {
+        _data = std::make_unique<AneuMeshLoader>();
+        _data->setReaderOptions(_options);
+        _data->setLoadOptions(_loadOptions);
+    }
 
     // fill data
-    void load(const std::string& path) const override { _data->loadMesh(path, true); }
+    void load(const std::string& path) override { _data->loadMesh(path, true); }
 
-    // getter
-    std::shared_ptr<AneuMeshLoader> GetObject() override {
-        std::shared_ptr<AneuMeshLoader> result = _data;
+    // getter (shared ownership)
+    std::shared_ptr<AneuMeshLoader> GetObject() override { return Release(); }
+
+    // hand over the loaded mesh and start a new one
+    std::unique_ptr<AneuMeshLoader> Release() override {
+        std::unique_ptr<AneuMeshLoader> result = std::move(_data);
         Reset();
         return result;
     }
 
 private:
     //AneuMeshLoader* _data;
-    std::shared_ptr<AneuMeshLoader> _data;
+    std::unique_ptr<AneuMeshLoader> _data;
+    ReaderOptions _options;
+    LoadOptions _loadOptions;
 };
 
 // derived builder class for loading data from aneu file
 class GatherDataBuilderAneu : public GatherDataBuilder {
 public:
     // constructor
-    GatherDataBuilderAneu() { Reset(); }
+    explicit GatherDataBuilderAneu(const ReaderOptions& options = {}, 
+                                   const LoadOptions&   loadOptions = {}) : _options(options), _loadOptions(loadOptions) { Reset(); }
 
     // destructor
     // ~GatherDataBuilderAneu() { delete _data; }
 
     // reset field
-    void Reset() override { _data.reset(new AneuMeshLoader()); }
+    void Reset() override {
+        _data = std::make_unique<AneuMeshLoader>();
+        _data->setReaderOptions(_options);
+        _data->setLoadOptions(_loadOptions);
+    }
 
     // fill data
-    void load(const std::string& path) const override { _data->loadMesh(path, false); }
+    void load(const std::string& path) override { _data->loadMesh(path, false); }
 
-    // getter
-    std::shared_ptr<AneuMeshLoader> GetObject() override {
-        std::shared_ptr<AneuMeshLoader> result = _data;
+    // getter (shared ownership)
+    std::shared_ptr<AneuMeshLoader> GetObject() override { return Release(); }
+
+    // hand over the loaded mesh and start a new one
+    std::unique_ptr<AneuMeshLoader> Release() override {
+        std::unique_ptr<AneuMeshLoader> result = std::move(_data);
         Reset();
         return result;
     }
 
 private:
-    std::shared_ptr<AneuMeshLoader> _data;
+    std::unique_ptr<AneuMeshLoader> _data;
+    ReaderOptions _options;
+    LoadOptions _loadOptions;
+};
+
+// result of loading one file of a batch
+struct BatchResult {
+    std::string _path;
+
+    // loaded mesh (nullptr if loading failed)
+    std::shared_ptr<AneuMeshLoader> _mesh;
+
+    // all of the statistics for the mesh (nullptr if not requested or failed)
+    std::shared_ptr<Statistics> _stats;
+
+    // error message (empty on success)
+    std::string _error;
 };
 
 class GatherDataDirector {
@@ -133,6 +217,14 @@ public:
     // fill data
     void GatherData(const std::string& path) const { _builder->load(path); }
 
+    // load many files concurrently (*.neu files with the neu builder, the rest with the aneu one),
+    // consumer gets every result as soon as it is ready (calls are serialized)
+    static void GatherDataBatch(const std::vector<std::string>&             paths,
+                                const std::function<void(BatchResult&&)>&   consumer,
+                                size_t                                      threads = 0,
+                                bool                                        countStatistics = true,
+                                const ReaderOptions&                        options = {});
+
 private:
     std::shared_ptr<GatherDataBuilder> _builder;
 };
@@ -150,22 +242,32 @@ public:
     void Reset() { _stats.reset(new Statistics()); }
 
     // fill _amountFEareaId
-    void CountFEByAreaId(std::shared_ptr<AneuMeshLoader>) const;
+    void CountFEByAreaId(const AneuMeshLoader&) const;
 
     // fill _amountBEareaId
-    void CountBEByAreaId(std::shared_ptr<AneuMeshLoader>) const;
+    void CountBEByAreaId(const AneuMeshLoader&) const;
 
     // fill _amountFENode
-    void CountNodesFE(std::shared_ptr<AneuMeshLoader>) const;
+    void CountNodesFE(const AneuMeshLoader&) const;
 
     // fill _amountBENode
-    void CountNodesBE(std::shared_ptr<AneuMeshLoader>) const;
+    void CountNodesBE(const AneuMeshLoader&) const;
 
-    // fill _commonNodeFE
-    void CommonNodeFE(std::shared_ptr<AneuMeshLoader>) const;
+    // fill _commonNodeFE (ties go to the smallest node id)
+    void CommonNodeFE(const AneuMeshLoader&) const;
 
-    // fill _commonNodeBE
-    void CommonNodeBE(std::shared_ptr<AneuMeshLoader>) const;
+    // fill _commonNodeBE (ties go to the smallest node id)
+    void CommonNodeBE(const AneuMeshLoader&) const;
+
+    // fill _qualityFEareaId
+    void MeshQuality(const AneuMeshLoader&) const;
+
+    // fill _amountFEareaId, _amountFENode, _commonNodeFE and _qualityFEareaId
+    // in the parallel traversals of MeshQuality (no separate counting pass)
+    void CountFEWithQuality(const AneuMeshLoader&) const;
+
+    // amount of bins in the edge length histograms
+    static constexpr size_t histogramBins = 10;
 
     // getter
     std::shared_ptr<Statistics> GetStat() {
@@ -175,6 +277,9 @@ public:
     }
 
 private:
+    // shared part of MeshQuality and CountFEWithQuality
+    void TraverseFE(const AneuMeshLoader&, bool) const;
+
     std::shared_ptr<Statistics> _stats;
 };
 
@@ -184,25 +289,25 @@ public:
     void set_builder(std::shared_ptr<StatsBuilder> builder) { _builder = builder; }
 
     // count only _amountFEareaId and _amountBEareaId
-    void CountAmountOfElementsByAreaId(std::shared_ptr<AneuMeshLoader> obj) const {
+    void CountAmountOfElementsByAreaId(const AneuMeshLoader& obj) const {
         _builder->CountFEByAreaId(obj);
         _builder->CountBEByAreaId(obj);
     };
 
     // count only _amountFENode and _amountBENode
-    void CountNodesInElements(std::shared_ptr<AneuMeshLoader> obj) const {
+    void CountNodesInElements(const AneuMeshLoader& obj) const {
         _builder->CountNodesFE(obj);
         _builder->CountNodesBE(obj);
     }
 
     // count only _commonNodeFE and _commonNodeBE
-    void CountCommonNodesInElements(std::shared_ptr<AneuMeshLoader> obj) const {
+    void CountCommonNodesInElements(const AneuMeshLoader& obj) const {
         _builder->CommonNodeFE(obj);
         _builder->CommonNodeBE(obj);
     }
 
     // count all of the statistics
-    void CountAllStatistics(std::shared_ptr<AneuMeshLoader> obj) const {
+    void CountAllStatistics(const AneuMeshLoader& obj) const {
         _builder->CountFEByAreaId(obj);
         _builder->CountBEByAreaId(obj);
         _builder->CountNodesFE(obj);
@@ -211,35 +316,47 @@ public:
         _builder->CommonNodeBE(obj);
     }
 
+    // count only _qualityFEareaId
+    void CountMeshQuality(const AneuMeshLoader& obj) const {
+        _builder->MeshQuality(obj);
+    }
+
+    // count all of the statistics and the mesh quality
+    // (the counts are taken in the traversals of the quality)
+    void CountAllStatisticsWithQuality(const AneuMeshLoader& obj) const {
+        _builder->CountFEWithQuality(obj);
+        _builder->CountBEByAreaId(obj);
+        _builder->CountNodesBE(obj);
+        _builder->CommonNodeBE(obj);
+    }
+
 private:
     std::shared_ptr<StatsBuilder> _builder;
 };
 
+// true for *.neu, *.neu.gz and *.neu.zst paths (they go through the neu builder)
+bool isNeuPath(const std::string&);
+
 inline void ClientCode(GatherDataDirector& gdDirector, 
                        const std::string&  path, 
                        StatsDirector&      sDirector) {
-    std::shared_ptr<GatherDataBuilderAneu> builder1(new GatherDataBuilderAneu());
+    std::shared_ptr<GatherDataBuilder> builder1;
+    if (isNeuPath(path)) builder1.reset(new GatherDataBuilderNeu());
+    else builder1.reset(new GatherDataBuilderAneu());
     gdDirector.set_builder(builder1);
     gdDirector.GatherData(path);
-    std::shared_ptr<AneuMeshLoader> obj = builder1->GetObject();
+    std::unique_ptr<AneuMeshLoader> obj = builder1->Release();
     //delete builder1;
 
     std::shared_ptr<StatsBuilder> builder2 (new StatsBuilder());
     sDirector.set_builder(builder2);
-    sDirector.CountAmountOfElementsByAreaId(obj);
+    sDirector.CountAllStatistics(*obj);
 
     std::shared_ptr<Statistics> stats = builder2->GetStat();
     stats->ShowData();
     std::cout << std::string(30, '-') << std::endl;
     //delete stats;
 
-    sDirector.CountAllStatistics(obj);
-
-    stats = builder2->GetStat();
-    stats->ShowData();
-    std::cout << std::string(30, '-') << std::endl;
-    //delete stats;
-
     //delete obj;
     //delete builder2;
 }
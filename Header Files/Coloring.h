@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef COLORING_H_INCLUDED
+#define COLORING_H_INCLUDED
+
+#include "FrozenMesh.h"
+
+// algorithm used for coloring the finite elements
+enum class ColoringStrategy {
+	Greedy,        // sequential first fit in id order, usually the fewest colors
+	JonesPlassmann // parallel rounds of local maxima of random weights
+};
+
+// finite elements split into colors, no two elements of one color share a node
+// (elements are positions in FrozenMesh::getFiniteElements())
+struct ElementColoring {
+	// color of every element
+	std::vector<size_t> _color;
+
+	// elements of color c are _elements[_colorOffsets[c]] .. _elements[_colorOffsets[c + 1] - 1],
+	// sorted by their first node inside a color for locality
+	std::vector<size_t> _colorOffsets;
+	std::vector<size_t> _elements;
+
+	// cache blocks: block b is _elements[_blockOffsets[b]] .. _elements[_blockOffsets[b + 1] - 1],
+	// blocks of color c are _colorBlocks[c] .. _colorBlocks[c + 1] - 1
+	std::vector<size_t> _blockOffsets;
+	std::vector<size_t> _colorBlocks;
+
+	// getter for amount of colors
+	size_t colors() const { return _colorOffsets.empty() ? 0 : _colorOffsets.size() - 1; }
+
+	// elements of one color
+	std::span<const size_t> color(size_t c) const {
+		return { _elements.data() + _colorOffsets[c], _colorOffsets[c + 1] - _colorOffsets[c] };
+	}
+};
+
+// color the finite elements over the node -> element incidence,
+// blockSize is the amount of elements in one cache block
+ElementColoring colorElements(const FrozenMesh&,
+			      ColoringStrategy = ColoringStrategy::Greedy,
+			      size_t blockSize = 256,
+			      ThreadPool& = ThreadPool::shared());
+
+// call body(element position) for every finite element, the colors one after another
+// and the blocks of a color in parallel, so body may scatter to nodes without atomics
+void forEachElementColored(const ElementColoring&,
+			   const std::function<void(size_t)>&,
+			   ThreadPool& = ThreadPool::shared());
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef COMPRESSION_H_INCLUDED
+#define COMPRESSION_H_INCLUDED
+
+#include <istream>
+#include <memory>
+
+// compression of a mesh file, detected by its magic bytes
+enum class Compression {
+	None,
+	Gzip, // 1f 8b, needs MESH_WITH_ZLIB
+	Zstd  // 28 b5 2f fd, needs MESH_WITH_ZSTD
+};
+
+// detect compression by the magic bytes (stream position is restored)
+Compression detectCompression(std::istream&);
+
+// abstract source of (decompressed) bytes for BufferedReader
+class ByteSource {
+public:
+	// destructor
+	virtual ~ByteSource() {}
+
+	// fill buffer, returns less than requested only at the end of data
+	virtual size_t read(char*, size_t) = 0;
+};
+
+// create a source that decompresses the stream on the fly
+std::unique_ptr<ByteSource> makeByteSource(std::istream&, Compression);
+
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef ELEMENTBUCKETS_H_INCLUDED
+#define ELEMENTBUCKETS_H_INCLUDED
+
+#include <cstdint>
+#include <span>
+
+#include "DataTypes.h"
+
+// shape of a finite or boundary element (midside nodes don't change the shape)
+enum class ElementType {
+	Segment,
+	Triangle,
+	Quadrilateral,
+	Tetrahedron,
+	Pyramid,
+	Prism,
+	Hexahedron,
+	Unknown
+};
+
+// shape of an element with an amount of nodes in a space of a given dimension
+// (boundary elements live in dimension spaceDim() - 1)
+ElementType elementType(size_t, size_t);
+
+// name of a shape for printing
+const char* elementTypeName(ElementType);
+
+// dimension of a shape (0 for Unknown)
+size_t elementDimension(ElementType);
+
+// amount of corner vertices of a shape, they come first in the node list (0 for Unknown)
+size_t vertexCount(ElementType);
+
+// edges of a shape as pairs of local vertex positions (VTK vertex order)
+std::span<const std::array<uint8_t, 2>> localEdges(ElementType);
+
+// length / area / volume of a shape from its corner coordinates (VTK vertex order, unused axes are 0),
+// signed by the vertex orientation when the shape has the dimension of the space, unsigned otherwise
+double signedMeasure(ElementType, std::span<const std::array<double, 3>>, size_t);
+
+// measure of the reference element of a shape (unit simplex, unit cube and the ones in between),
+// signedMeasure over it is the mean jacobian determinant of the element
+double referenceMeasure(ElementType);
+
+// elements of one shape and one amount of nodes, connectivity in a fixed-stride array
+struct ElementBucket {
+	ElementType _type = ElementType::Unknown;
+	size_t _arity{};
+
+	// positions in getFiniteElements() / getBoundaryElements(), ascending
+	std::vector<size_t> _positions;
+
+	// element ids and material / surface area ids
+	std::vector<size_t> _ids;
+	std::vector<size_t> _areaIds;
+
+	// node ids, _arity per element
+	std::vector<size_t> _nodes;
+
+	// amount of elements in the bucket
+	size_t size() const { return _positions.size(); }
+
+	// node ids of the element k of the bucket
+	std::span<const size_t> nodes(size_t k) const { return { _nodes.data() + k * _arity, _arity }; }
+};
+
+// elements of a block split into homogeneous buckets, with the element id -> (bucket, index) map
+struct ElementBuckets {
+	// buckets ordered by shape, then by amount of nodes
+	std::vector<ElementBucket> _buckets;
+
+	// element ids in block order (sorted) and the bucket / index in the bucket of every position
+	std::vector<size_t> _ids;
+	std::vector<uint32_t> _bucketOf;
+	std::vector<size_t> _indexOf;
+
+	// place of an element in the buckets
+	struct Location {
+		size_t _bucket{};
+		size_t _index{};
+	};
+
+	// value used by locate for a missing element
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	// bucket and index of an element id ({ npos, npos } if it is not present)
+	Location locate(size_t) const;
+
+	// bucket with a shape and an amount of nodes (nullptr if there is none)
+	const ElementBucket* find(ElementType, size_t) const;
+
+	// true if the block has elements of more than one shape or amount of nodes
+	bool mixed() const { return _buckets.size() > 1; }
+};
+
+// split the finite elements (sorted by id) of a mesh with a given space dimension into buckets
+ElementBuckets bucketElements(const std::vector<FiniteElement>&, size_t);
+
+// split the boundary elements (sorted by id) of a mesh with a given space dimension into buckets
+ElementBuckets bucketElements(const std::vector<BoundaryElement>&, size_t);
+
+#endif
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <exception>
 #include <iostream>
+#include <string>
 
-class Exception : std::exception {
+// public base, so it can be caught as std::exception
+class Exception : public std::exception {
 public:
     // Initializing
     explicit Exception();
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef EXPECTED_H_INCLUDED
+#define EXPECTED_H_INCLUDED
+
+#include <optional>
+#include <string>
+#include <variant>
+
+#include "Exception.h"
+
+// kind of error reported by the try* methods
+enum class ErrorCode {
+	OpenFailed,    // the file can't be opened or created
+	UnexpectedEnd, // the file ends before the announced amount of lines
+	BadHeader,     // a block header has no amount in front
+	BadNumber,     // a token isn't a number of the expected type
+	BadRecord,     // a line has another amount of tokens than its block
+	MissingNode,   // a queried node isn't present
+	NotVertex,     // a queried node isn't a vertex of any element
+	Io,            // the reader, the decompressor or an allocation failed
+	Cancelled      // LoadOptions::_progress stopped the load
+};
+
+// name of an error code
+const char* errorName(ErrorCode);
+
+// error with its position in the file (0 if it doesn't belong to one)
+struct MeshError {
+	ErrorCode _code{};
+	size_t _offset{}; // byte offset of the token in the (decompressed) text
+	size_t _line{};   // 1-based line
+	std::string _message;
+
+	// one line description with the position
+	std::string describe() const;
+};
+
+// value or MeshError, like std::expected
+template <class T>
+class Expected {
+public:
+	Expected(T value) : _data(std::in_place_index<0>, std::move(value)) {}
+	Expected(MeshError error) : _data(std::in_place_index<1>, std::move(error)) {}
+
+	// true if there is a value
+	bool hasValue() const { return _data.index() == 0; }
+	explicit operator bool() const { return hasValue(); }
+
+	// the value, throws Exception with the error description if there is none
+	T& value() & { check(); return std::get<0>(_data); }
+	const T& value() const & { check(); return std::get<0>(_data); }
+	T&& value() && { check(); return std::get<0>(std::move(_data)); }
+
+	// the value without a check
+	T& operator * () { return std::get<0>(_data); }
+	const T& operator * () const { return std::get<0>(_data); }
+	T* operator -> () { return &std::get<0>(_data); }
+	const T* operator -> () const { return &std::get<0>(_data); }
+
+	// the error (only if there is no value)
+	const MeshError& error() const { return std::get<1>(_data); }
+private:
+	void check() const {
+		if (!hasValue()) throw Exception(error().describe());
+	}
+
+	std::variant<T, MeshError> _data;
+};
+
+// success or MeshError
+template <>
+class Expected<void> {
+public:
+	Expected() = default;
+	Expected(MeshError error) : _error(std::move(error)) {}
+
+	// true if there is no error
+	bool hasValue() const { return !_error; }
+	explicit operator bool() const { return hasValue(); }
+
+	// throws Exception with the error description if there is one
+	void value() const {
+		if (_error) throw Exception(_error->describe());
+	}
+
+	// the error (only if there is one)
+	const MeshError& error() const { return *_error; }
+private:
+	std::optional<MeshError> _error;
+};
+
+#endif
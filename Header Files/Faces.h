@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef FACES_H_INCLUDED
+#define FACES_H_INCLUDED
+
+#include "FrozenMesh.h"
+
+// face of a finite element
+struct FaceRef {
+	size_t _element{};   // finite element id
+	size_t _localFace{}; // index in localFaces() of the element type
+};
+
+// face topology of a mesh: exterior faces and boundary element owners
+struct FaceTopology {
+	// faces used by one finite element only (the skin of the mesh)
+	std::vector<FaceRef> _exteriorFaces;
+
+	// amount of faces shared by two finite elements
+	size_t _interiorFaces{};
+
+	// finite element ids of both sides of every interior face (smaller id first)
+	std::vector<std::pair<size_t, size_t>> _interiorFacePairs;
+
+	// faces shared by more than two finite elements (broken connectivity)
+	std::vector<FaceRef> _nonManifoldFaces;
+
+	// boundary element id -> owning finite element and its local face
+	// (for a boundary element on an interior face, the owner with the smaller id)
+	std::unordered_map<size_t, FaceRef> _boundaryOwners;
+
+	// boundary elements lying on an interior face (e.g. between materials)
+	std::vector<size_t> _interiorBoundaryElements;
+
+	// boundary elements that are not a face of any finite element
+	std::vector<size_t> _unmatchedBoundaryElements;
+
+	// exterior faces not covered by a boundary element
+	std::vector<FaceRef> _uncoveredFaces;
+
+	// true if the boundary elements match the skin of the mesh exactly
+	bool skinMatches() const { return _unmatchedBoundaryElements.empty() && _uncoveredFaces.empty(); }
+};
+
+// faces of an element type as local vertex positions, empty for unknown types
+// (dim 2: triangle, quadrilateral; dim 3: tetrahedron, pyramid, prism, hexahedron;
+//  quadratic elements with midside nodes after the vertices use the faces of their linear type)
+const std::vector<std::vector<size_t>>& localFaces(size_t dim, size_t nodes);
+
+// amount of vertices of a face or boundary element with a given amount of nodes (0 if unknown)
+size_t faceVertices(size_t dim, size_t nodes);
+
+// enumerate the faces of all finite elements, hash their sorted vertex keys into buckets
+// and match every face and boundary element in one parallel pass
+FaceTopology buildFaceTopology(const FrozenMesh&, ThreadPool& = ThreadPool::shared());
+
+#endif
@@ -0,0 +1,159 @@
+#pragma once
+
+#ifndef FROZENMESH_H_INCLUDED
+#define FROZENMESH_H_INCLUDED
+
+#include <mutex>
+#include <span>
+
+#include "ElementBuckets.h"
+#include "Incidence.h"
+#include "Mesh.h"
+#include "ThreadPool.h"
+
+struct BinaryMeshView;
+
+// results of a batch of queries in CSR form: element ids found for query i are
+// _elements[_offsets[i]] .. _elements[_offsets[i + 1] - 1], sorted by id
+struct QueryBatchResult {
+	std::vector<size_t> _offsets;
+	std::vector<size_t> _elements;
+
+	// amount of queries in the batch
+	size_t size() const { return _offsets.empty() ? 0 : _offsets.size() - 1; }
+
+	// element ids found for one query
+	std::span<const size_t> operator[](size_t i) const {
+		return { _elements.data() + _offsets[i], _offsets[i + 1] - _offsets[i] };
+	}
+
+	// per chunk buffers, kept between calls to avoid reallocations
+	std::vector<std::vector<size_t>> _chunkElements;
+	std::vector<size_t> _counts;
+};
+
+// immutable snapshot of a loaded mesh:
+// every query is const and lock-free after the lazy indices are built once,
+// so one snapshot can be shared by many threads
+class FrozenMesh {
+public:
+	// constructor (copies the mesh, the loader may be changed or destroyed afterwards)
+	explicit FrozenMesh(const AneuMeshLoader&);
+
+	// constructor from an image in the binary cache format (copies the data)
+	explicit FrozenMesh(const BinaryMeshView&);
+
+	FrozenMesh(const FrozenMesh&) = delete;
+	FrozenMesh& operator = (const FrozenMesh&) = delete;
+
+	// getter Node (sorted by id)
+	const std::vector<Node>& getNodes() const { return _nodes; }
+
+	// getter Finite Element (sorted by id)
+	const std::vector<FiniteElement>& getFiniteElements() const { return _finiteElements; }
+
+	// getter Boundary Element (sorted by id)
+	const std::vector<BoundaryElement>& getBoundaryElements() const { return _boundaryElements; }
+
+	// getter for one Node by id (nullptr if it is not present)
+	const Node* findNode(size_t) const;
+
+	// getter for amount of Nodes
+	size_t sizeNodes() const { return _nodes.size(); }
+
+	// getter for amount of Finite Elements
+	size_t sizeFiniteElements() const { return _finiteElements.size(); }
+
+	// getter for amount of Boundary Elements
+	size_t sizeBoundaryElements() const { return _boundaryElements.size(); }
+
+	// getter for a Space Dimension
+	size_t spaceDim() const { return _spaceDimension; }
+
+	// getter for an amount of node in one Finite Element (the largest one for mixed elements)
+	size_t nodesInFE() const { return _amountOfNodesInOneFiniteElement; }
+
+	// getter for an amount of node in one Boundary Element (the largest one for mixed elements)
+	size_t nodesInBE() const { return _amountOfNodesInOneBoundaryElement; }
+
+	// Finite Elements split by shape and amount of nodes (built on first use)
+	const ElementBuckets& finiteBuckets() const;
+
+	// Boundary Elements split by shape and amount of nodes (built on first use)
+	const ElementBuckets& boundaryBuckets() const;
+
+	// method for finding Finite Elements by 3 vertex Node ids
+	std::vector<FiniteElement> findFiniteElementsByVertices(size_t, size_t, size_t) const;
+
+	// method for finding Finite Elements by 2 Node ids
+	std::vector<FiniteElement> findFiniteElementsByEdges(size_t, size_t) const;
+
+	// findFiniteElementsByVertices without exceptions
+	Expected<std::vector<FiniteElement>> tryFindFiniteElementsByVertices(size_t, size_t, size_t) const;
+
+	// findFiniteElementsByEdges without exceptions
+	Expected<std::vector<FiniteElement>> tryFindFiniteElementsByEdges(size_t, size_t) const;
+
+	// batched method for finding Finite Elements by pairs of Node ids (parallel)
+	void findFiniteElementsByEdges(std::span<const std::array<size_t, 2>>, 
+				       QueryBatchResult&, 
+				       ThreadPool& = ThreadPool::shared()) const;
+
+	// batched method for finding Finite Elements by triples of vertex Node ids (parallel)
+	void findFiniteElementsByVertices(std::span<const std::array<size_t, 3>>, 
+					  QueryBatchResult&, 
+					  ThreadPool& = ThreadPool::shared()) const;
+
+	// method for finding Boundary Elements by an area ID
+	std::vector<BoundaryElement> findBoundaryElementsByAreaID(size_t) const;
+
+	// method for finding Finite Elements by a material ID
+	std::vector<FiniteElement> findFiniteElementsByMaterialID(size_t) const;
+
+	// method for finding all unique Nodes of Boundary Elements with the same given area ID
+	std::vector<Node> findBENodesByAreaID(size_t) const;
+
+	// value returned by nodeIndex for a missing node
+	static constexpr size_t npos = NodeIncidence::npos;
+
+	// position of a Node in getNodes() (npos if it is not present)
+	size_t nodeIndex(size_t) const;
+
+	// positions in getFiniteElements() of the elements using a node position (sorted)
+	std::span<const size_t> elementsOfNode(size_t) const;
+
+private:
+	// node -> finite elements incidence in CSR form (built on first use)
+	void buildIncidence() const;
+
+	// area id -> boundary elements positions (built on first use)
+	void buildAreaIndex() const;
+
+	// finite elements containing all given node ids, checked for presence and, if asked, for being vertices
+	Expected<std::vector<FiniteElement>> findByNodes(std::initializer_list<size_t>, bool) const;
+
+	// shared part of the batched queries
+	template <size_t N>
+	void findBatch(std::span<const std::array<size_t, N>>, QueryBatchResult&, ThreadPool&) const;
+
+	size_t _spaceDimension{};
+	size_t _amountOfNodesInOneFiniteElement{};
+	size_t _amountOfNodesInOneBoundaryElement{};
+	std::vector<Node> _nodes;
+	std::vector<FiniteElement> _finiteElements;
+	std::vector<BoundaryElement> _boundaryElements;
+
+	mutable std::once_flag _incidenceFlag;
+	mutable NodeIncidence _incidence;
+
+	mutable std::once_flag _areaFlag;
+	mutable std::unordered_map<size_t, std::vector<size_t>> _areaIndex;
+
+	mutable std::once_flag _finiteBucketsFlag;
+	mutable ElementBuckets _finiteBuckets;
+
+	mutable std::once_flag _boundaryBucketsFlag;
+	mutable ElementBuckets _boundaryBuckets;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef GEOMETRY_H_INCLUDED
+#define GEOMETRY_H_INCLUDED
+
+#include "FrozenMesh.h"
+
+// instruction set used by the geometry kernels
+enum class SimdLevel {
+	Auto,   // best one supported by the cpu
+	Scalar,
+	Avx2,
+	Avx512
+};
+
+// best instruction set supported by the cpu (checked once at runtime)
+SimdLevel detectSimdLevel();
+
+// per-element geometric quantities, position i belongs to getFiniteElements()[i]
+struct ElementGeometry {
+	// id of every element
+	std::vector<size_t> _ids;
+
+	// determinant of the affine map from the reference simplex, for quadrilaterals, pyramids,
+	// prisms and hexahedra its mean over the element (signed, 0 for unknown shapes)
+	std::vector<double> _jacobian;
+
+	// area in 2D, volume in 3D (0 for unknown shapes)
+	std::vector<double> _measure;
+
+	// centroid of the vertices, spaceDim() values per element
+	std::vector<double> _centroid;
+
+	// orientation of the majority of the measured elements (1 or -1)
+	int _sign = 1;
+
+	// ids of measured elements against the majority orientation or with a zero jacobian
+	std::vector<size_t> _inverted;
+
+	// instruction set the kernels ran with
+	SimdLevel _level = SimdLevel::Scalar;
+};
+
+// compute jacobians, measures and centroids of all finite elements at once, one element bucket after another:
+// triangles in 2D and tetrahedra in 3D are gathered into SoA arrays and processed by AVX-512/AVX2 kernels
+// (scalar fallback), the other shapes by a scalar kernel that splits them into simplices
+ElementGeometry computeGeometry(const FrozenMesh&, 
+				ThreadPool& = ThreadPool::shared(), 
+				SimdLevel = SimdLevel::Auto);
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef INCIDENCE_H_INCLUDED
+#define INCIDENCE_H_INCLUDED
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "Expected.h"
+
+// node -> elements incidence in CSR form, shared by FrozenMesh and the views of published images:
+// nodes and elements are addressed by their positions in lists sorted by id, the elements using
+// the node at position i are _elements[_offsets[i]] .. _elements[_offsets[i + 1] - 1], sorted
+class NodeIncidence {
+public:
+	// value returned by position for a missing id
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	// position of an id in a list sorted by the projected ids (npos if it is not present)
+	template <class Range, class Projection = std::identity>
+	static size_t position(const Range&, size_t, Projection = {});
+
+	NodeIncidence() = default;
+
+	// constructor from the amount of nodes and elements, the position of a node id
+	// and the node ids of an element position (nodes without a position are skipped)
+	template <class NodePosition, class ElementNodes>
+	NodeIncidence(size_t, size_t, NodePosition, ElementNodes);
+
+	// positions of the elements using a node position (sorted)
+	std::span<const size_t> elementsOf(size_t node) const {
+		return { _elements.data() + _offsets[node], _offsets[node + 1] - _offsets[node] };
+	}
+
+	// positions of the elements using all of the node positions (sorted, every element once)
+	std::vector<size_t> intersect(std::span<const size_t>) const;
+
+	// intersect appending to a buffer, the scratch buffer is kept by the caller between calls
+	void intersect(std::span<const size_t>, std::vector<size_t>&, std::vector<size_t>&) const;
+
+private:
+	std::vector<size_t> _offsets;
+	std::vector<size_t> _elements;
+};
+
+// checks the node positions of an element query: every node must be present and,
+// for a query by vertices, isVertex(position) must hold for all of them
+Expected<void> checkQueryNodes(std::span<const size_t>, bool, const std::function<bool(size_t)>& = {});
+
+// definition for method for the position of an id in a sorted list
+template <class Range, class Projection>
+size_t NodeIncidence::position(const Range& sorted, size_t id, Projection projection) {
+	// ids are usually 1..n without gaps
+	size_t size = std::ranges::size(sorted);
+	if (id >= 1 && id <= size && static_cast<size_t>(std::invoke(projection, sorted[id - 1])) == id) return id - 1;
+
+	auto it = std::ranges::lower_bound(sorted, id, {}, projection);
+	if (it == std::ranges::end(sorted) || static_cast<size_t>(std::invoke(projection, *it)) != id) return npos;
+	return static_cast<size_t>(it - std::ranges::begin(sorted));
+}
+
+// definition for constructor of the incidence
+template <class NodePosition, class ElementNodes>
+NodeIncidence::NodeIncidence(size_t nodes, size_t elements, NodePosition nodePosition, ElementNodes elementNodes) :
+	_offsets(nodes + 1, 0) {
+	for (size_t e = 0; e < elements; ++e)
+		for (const auto& id : elementNodes(e))
+			if (size_t index = nodePosition(id); index != npos) _offsets[index + 1]++;
+
+	std::partial_sum(begin(_offsets), end(_offsets), begin(_offsets));
+
+	// elements are visited in position order, so every list ends up sorted
+	_elements.resize(_offsets.back());
+	std::vector<size_t> fill(begin(_offsets), end(_offsets) - 1);
+	for (size_t e = 0; e < elements; ++e)
+		for (const auto& id : elementNodes(e))
+			if (size_t index = nodePosition(id); index != npos) _elements[fill[index]++] = e;
+}
+
+#endif
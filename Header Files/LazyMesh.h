@@ -0,0 +1,128 @@
+#pragma once
+
+#ifndef LAZYMESH_H_INCLUDED
+#define LAZYMESH_H_INCLUDED
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include "Mesh.h"
+
+// settings for LazyMeshLoader
+struct LazyOptions {
+	// lines between two byte offset checkpoints (one cache page)
+	size_t _checkpointInterval = 256;
+
+	// amount of parsed pages kept in the LRU cache
+	size_t _cachePages = 64;
+
+	// read the index from <path>.idx if it is up to date, write it otherwise
+	bool _useSidecar = true;
+};
+
+// lazy loader for uncompressed *.aneu / *.neu files:
+// opening the file only indexes newlines (or reads the sidecar index),
+// nodes and elements are parsed page by page on first access and kept in an LRU cache,
+// ids are the same as in AneuMeshLoader (boundary elements continue after finite elements)
+class LazyMeshLoader {
+public:
+	// constructor (builds or reads the block index)
+	explicit LazyMeshLoader(const std::string&, const LazyOptions& = {});
+
+	// getter for amount of Nodes
+	size_t sizeNodes() const { return _nodes; }
+
+	// getter for amount of Finite Elements
+	size_t sizeFiniteElements() const { return _finiteElements; }
+
+	// getter for amount of Boundary Elements
+	size_t sizeBoundaryElements() const { return _boundaryElements; }
+
+	// getter for a Space Dimension
+	size_t spaceDim() const { return _spaceDimension; }
+
+	// getter for an amount of node in one Finite Element
+	size_t nodesInFE() const { return _amountOfNodesInOneFiniteElement; }
+
+	// getter for an amount of node in one Boundary Element
+	size_t nodesInBE() const { return _amountOfNodesInOneBoundaryElement; }
+
+	// getter Node by id (1..sizeNodes())
+	Node getNode(size_t) const;
+
+	// getter Finite Element by id (1..sizeFiniteElements())
+	FiniteElement getFiniteElement(size_t) const;
+
+	// getter Boundary Element by id (sizeFiniteElements() + 1 ..)
+	BoundaryElement getBoundaryElement(size_t) const;
+
+	// getter for a range of Finite Elements {first id, amount}
+	std::vector<FiniteElement> getFiniteElements(size_t, size_t) const;
+
+	// method for finding Finite Elements by 2 Node ids (scans every finite element page)
+	std::vector<FiniteElement> findFiniteElementsByEdges(size_t, size_t) const;
+
+	// method for finding Finite Elements by a material ID (scans every finite element page)
+	std::vector<FiniteElement> findFiniteElementsByMaterialID(size_t) const;
+
+	// method for finding Boundary Elements by an area ID (scans every boundary element page)
+	std::vector<BoundaryElement> findBoundaryElementsByAreaID(size_t) const;
+
+	// amount of pages parsed since opening (cache misses)
+	size_t pagesParsed() const { return _pagesParsed; }
+
+private:
+	// parsed lines of one page
+	struct Page {
+		std::vector<Node> _nodes;
+		std::vector<FiniteElement> _finiteElements;
+		std::vector<BoundaryElement> _boundaryElements;
+	};
+
+	// newline pass over the whole file
+	void buildIndex();
+
+	// sidecar index, true if it was read and matches the file
+	bool readSidecar(const std::string&);
+	void writeSidecar(const std::string&) const;
+
+	// raw lines of a page
+	std::vector<std::string> readLines(size_t) const;
+
+	// page through the LRU cache (the shared_ptr keeps it alive after eviction),
+	// without keeping a missing page is parsed but not cached and a cached one keeps its place
+	std::shared_ptr<const Page> page(size_t, bool = true) const;
+
+	// pages with the lines first .. last - 1 one after another, so a scan holds one page at a time
+	// and leaves the cache of the point queries as it is
+	void scanPages(size_t, size_t, const std::function<void(const Page&)>&) const;
+
+	// line number of a node / element id
+	size_t nodeLine(size_t id) const { return id; }
+	size_t finiteElementLine(size_t id) const { return _nodes + 1 + id; }
+	size_t boundaryElementLine(size_t id) const { return _nodes + 1 + id + 1; }
+
+	std::string _path;
+	LazyOptions _options;
+	size_t _fileSize{};
+
+	// byte offsets of every _checkpointInterval-th line, the last one is the file end
+	std::vector<uint64_t> _checkpoints;
+	size_t _lines{};
+
+	size_t _nodes{};
+	size_t _finiteElements{};
+	size_t _boundaryElements{};
+	size_t _spaceDimension{};
+	size_t _amountOfNodesInOneFiniteElement{};
+	size_t _amountOfNodesInOneBoundaryElement{};
+
+	mutable std::mutex _mutex;
+	mutable std::ifstream _file;
+	mutable std::list<std::pair<size_t, std::shared_ptr<const Page>>> _lru;
+	mutable std::unordered_map<size_t, decltype(_lru)::iterator> _cache;
+	mutable size_t _pagesParsed{};
+};
+
+#endif
@@ -3,8 +3,117 @@
 #ifndef MESH_H_INCLUDED
 #define MESH_H_INCLUDED
 
+#include <functional>
+
 #include "DataTypes.h"
 #include "Exception.h"
+#include "Expected.h"
+#include "Reader.h"
+#include "Reorder.h"
+
+// position of a running loadMesh, reported to LoadOptions::_progress
+struct LoadProgress {
+	size_t _bytes{};    // bytes parsed so far (of the decompressed text)
+	size_t _fileSize{}; // size of the parsed file on disk (compressed files parse more bytes than that)
+	size_t _nodes{};    // node lines read so far
+	size_t _elements{}; // finite and boundary element lines read so far
+};
+
+// settings for partial loading in loadMesh
+struct LoadOptions {
+	// don't parse the finite element block
+	bool _skipFiniteElements = false;
+
+	// don't read the boundary element block at all
+	bool _skipBoundaryElements = false;
+
+	// load only finite elements with these material area ids (empty = all)
+	std::unordered_set<size_t> _materialIds;
+
+	// load only boundary elements with these surface area ids (empty = all)
+	std::unordered_set<size_t> _surfaceIds;
+
+	// drop nodes not used by the loaded elements and renumber the rest 1..n
+	// (element ids always stay the ones from the file)
+	bool _compactNodes = false;
+
+	// check the file while loading and collect the problems into a ValidationReport
+	// (nothing is thrown for them, the mesh is loaded as it is)
+	bool _validate = false;
+
+	// skip records with malformed numbers or another amount of nodes than their block
+	// (and stop at a truncated block) instead of failing, see getSkippedRecords
+	bool _lenient = false;
+
+	// elements of a block may have different amounts of nodes (e.g. tetrahedra with prisms),
+	// they are kept without an Arity issue and nodesInFE / nodesInBE give the largest amount
+	bool _mixedElements = false;
+
+	// called on the loading thread every few thousand lines and once at the end,
+	// returning false stops the load with ErrorCode::Cancelled (the loader keeps what was read)
+	std::function<bool(const LoadProgress&)> _progress;
+};
+
+// kind of problem found by the validation pass
+enum class ValidationCheck {
+	ColumnCount, // node line with another amount of coordinates than the first one
+	Arity,       // element line with another amount of nodes than its block (header column or first element)
+	MissingNode, // element references a node id that isn't in the node block
+	Degenerate,  // element uses one node more than once
+	Duplicate,   // element with the same nodes as another one of its block
+	OrphanNode,  // node not used by any element
+	BoundaryFace // boundary element whose nodes don't belong to one finite element
+};
+
+// one problem of the loaded file
+struct ValidationIssue {
+	ValidationCheck _check{};
+	size_t _line{}; // line in the *.aneu file (1-based)
+	size_t _id{};   // node or element id
+	std::string _message;
+};
+
+// problems found by loadMesh with LoadOptions::_validate
+struct ValidationReport {
+	// issues sorted by line, at most _maxIssues of them are kept
+	std::vector<ValidationIssue> _issues;
+
+	// amount of issues of every check (including the ones not kept)
+	std::array<size_t, 7> _counts{};
+
+	size_t _maxIssues = 1000;
+
+	// true if nothing was found
+	bool ok() const { return std::ranges::all_of(_counts, [](size_t c) { return c == 0; }); }
+
+	// getter for amount of issues of one check
+	size_t count(ValidationCheck check) const { return _counts[static_cast<size_t>(check)]; }
+
+	// add issues, sort them by line and drop the ones over _maxIssues
+	void merge(std::vector<ValidationIssue>&&);
+
+	// summary and one line per kept issue
+	void print(std::ostream&) const;
+};
+
+// sparsity pattern of a global matrix in CSR form
+// (dof of component c of the node _nodeIds[k] is k * _dofsPerNode + c)
+struct SparsityPattern {
+	size_t _dofsPerNode{};
+
+	// node ids in dof order (sorted)
+	std::vector<size_t> _nodeIds;
+
+	// columns of row r are _colIdx[_rowPtr[r]] .. _colIdx[_rowPtr[r + 1] - 1], sorted
+	std::vector<size_t> _rowPtr;
+	std::vector<size_t> _colIdx;
+
+	// getter for amount of rows
+	size_t rows() const { return _rowPtr.empty() ? 0 : _rowPtr.size() - 1; }
+
+	// getter for amount of stored entries
+	size_t nonZeros() const { return _colIdx.size(); }
+};
 
 // Base abstract class
 class MeshLoader abstract {
@@ -14,7 +123,7 @@ public:
 
 	// print method for Node/FiniteElement/BoundaryElement
 	template <class T>
-	static void print(T, std::ostream&);
+	static void print(const T&, std::ostream&);
 
 	// virtual getter Node
 	virtual std::vector<Node> getNodes() const = 0;
@@ -71,9 +180,47 @@ public:
 	// turn *.neu file to *.aneu
 	static std::fstream NeuToAneu(std::fstream&, const std::string&);
 
+	// path of the *.aneu written by loadMesh for a *.neu file (the path after the last '\\'
+	// with the new extension, so a Windows path leads to the working directory)
+	static std::string NeuToAneuPath(const std::string&);
+
 	// loadMesh method in a derived class for the files with type *.aneu
 	void loadMesh(const std::string&, bool);
 
+	// loadMesh without exceptions: the error has its code, line and byte offset
+	// (the mesh keeps what was read before the error)
+	Expected<void> tryLoadMesh(const std::string&, bool) noexcept;
+
+	// getter for the records skipped by the last lenient loadMesh
+	const std::vector<MeshError>& getSkippedRecords() const { return _skippedRecords; }
+
+	// setter for the buffer size and count used by loadMesh
+	void setReaderOptions(const ReaderOptions& options) { _readerOptions = options; }
+
+	// loadMesh with partial loading settings
+	void loadMesh(const std::string& path, bool neu, const LoadOptions& options) {
+		_loadOptions = options;
+		loadMesh(path, neu);
+	}
+
+	// setter for the partial loading settings used by loadMesh
+	void setLoadOptions(const LoadOptions& options) { _loadOptions = options; }
+
+	// getter for the node compaction applied by loadMesh (file id <-> loaded id, empty if there was none)
+	const Permutation& getCompaction() const { return _compaction; }
+
+	// setter for the node renumbering applied at the end of loadMesh (after the compaction)
+	void setReorderStrategy(ReorderStrategy strategy) { _reorderStrategy = strategy; }
+
+	// getter for the renumbering applied by loadMesh (empty if there was none)
+	const Renumbering& getRenumbering() const { return _renumbering; }
+
+	// getter for the problems found by the last loadMesh (empty if it didn't validate)
+	const ValidationReport& getValidationReport() const { return _validation; }
+
+	// renumber nodes and finite elements (ids missing in the permutations are kept)
+	void renumber(const Renumbering&);
+
 	// getter Node in a derived class for the files with type *.aneu
 	std::vector<Node> getNodes() const;
 
@@ -83,6 +230,15 @@ public:
 	// getter Surface Finite element in a derived class for the files with type *.aneu
 	std::vector<BoundaryElement> getBoundaryElements() const;
 
+	// read-only access to the stored Nodes without copying (unordered)
+	const std::unordered_map<size_t, Node>& nodesMap() const { return _nodesMap; }
+
+	// read-only access to the stored Finite Elements without copying (unordered)
+	const std::unordered_set<FiniteElement, Hash>& finiteElementsSet() const { return _finiteElementsSet; }
+
+	// read-only access to the stored Surface Finite Elements without copying (unordered)
+	const std::unordered_set<BoundaryElement, Hash>& boundaryElementsSet() const { return _boundaryElementsSet; }
+
 	// getter for amount of Nodes in a derived class for the files with type *.aneu
 	size_t sizeNodes() const { return _nodesMap.size(); }
 
@@ -107,6 +263,12 @@ public:
 	// method for finding Finite Elements by 2 Node ids
 	std::vector<FiniteElement> findFiniteElementsByEdges(size_t, size_t);
 
+	// findFiniteElementsByVertices without exceptions
+	Expected<std::vector<FiniteElement>> tryFindFiniteElementsByVertices(size_t, size_t, size_t) const;
+
+	// findFiniteElementsByEdges without exceptions
+	Expected<std::vector<FiniteElement>> tryFindFiniteElementsByEdges(size_t, size_t) const;
+
 	// method for finding Surface Finite Elements by an area ID
 	std::vector<BoundaryElement> findBoundaryElementsByAreaID(size_t) const;
 
@@ -121,18 +283,76 @@ public:
 
 	// method for neighbours
 	std::unordered_map<size_t, std::unordered_set<Node, Hash>> findNeighbours() const;
+
+	// sparsity pattern of the global matrix from the finite element connectivity (parallel),
+	// every node has dofsPerNode dofs, upperOnly keeps only the columns >= row
+	SparsityPattern buildSparsityPattern(size_t dofsPerNode = 1, bool upperOnly = false) const;
+
+	// uniform red refinement repeated levels times: triangle -> 4, tetrahedron -> 8,
+	// boundary segment -> 2, boundary triangle -> 4 (linear elements only)
+	// elements are renumbered, area ids are kept
+	void refineUniform(size_t levels = 1);
+
+	// adaptive refinement of the Finite Elements with given ids (missing ids are ignored),
+	// neighbours are bisected or refined as well to keep the mesh conforming
+	void refineMarked(const std::unordered_set<size_t>&);
 private:
+	// shared part of loadMesh and tryLoadMesh, only failures below the parser are thrown
+	Expected<void> load(const std::string&, bool);
+
+	// unique edges of the elements, sorted (the table index identifies an edge)
+	struct EdgeTable {
+		std::vector<std::pair<size_t, size_t>> _edges;
+
+		// table index of the edge between two nodes
+		size_t index(size_t, size_t) const;
+	};
+
+	// edge table over all node pairs of every element (parallel)
+	EdgeTable buildEdgeTable(const std::vector<FiniteElement>&, const std::vector<BoundaryElement>&) const;
+
+	// add a node in the middle of every edge with split[index] set (every edge for nullptr),
+	// marked as a vertex or not (corners of refined elements are, midside nodes of quadratic ones aren't),
+	// returns the new node id per table index (0 for edges that are not split)
+	std::vector<size_t> addMidsideNodes(const EdgeTable&, const std::vector<char>*, bool);
+
+	// shared part of refineUniform and refineMarked (nullptr refines every element)
+	void refine(const std::unordered_set<size_t>*);
+
+	// connectivity of one block collected while parsing for validate (flat, in file order),
+	// nodes are stored as id - 1 (amount of nodes in the file if undefined),
+	// nodes of the k-th element end at _nodes[_offsets[k]]
+	struct ValidationBlock {
+		std::vector<size_t> _ids;
+		std::vector<size_t> _offsets;
+		std::vector<size_t> _nodes;
+	};
+
+	// checks of LoadOptions::_validate that need the whole mesh (parallel),
+	// run before compaction and renumbering while the ids still give the file lines
+	void validate(size_t nodesInFile, const ValidationBlock&, const ValidationBlock&);
+
 	size_t _spaceDimension{};
 	size_t _amountOfNodesInOneFiniteElement{}; 
 	size_t _amountOfNodesInOneBoundaryElement{}; 
 	std::unordered_map<size_t, Node> _nodesMap; 
 	std::unordered_set<FiniteElement, Hash> _finiteElementsSet; 
 	std::unordered_set<BoundaryElement, Hash> _boundaryElementsSet;
+	// drop nodes not used by any element and renumber the rest 1..n
+	void compactNodes();
+
+	ReaderOptions _readerOptions{};
+	LoadOptions _loadOptions{};
+	Permutation _compaction{};
+	ReorderStrategy _reorderStrategy = ReorderStrategy::None;
+	Renumbering _renumbering{};
+	ValidationReport _validation{};
+	std::vector<MeshError> _skippedRecords;
 };
 
 // definition for print method for Node/FiniteElement/BoundaryElement
 template <class T>
-void MeshLoader::print(T el, std::ostream& output) {
+void MeshLoader::print(const T& el, std::ostream& output) {
 	if constexpr (std::is_same_v<T, Node>) {
 		output << "Node id: " << el._id << std::endl;
 		output << "Node _coords: { ";
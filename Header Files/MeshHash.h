@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef MESHHASH_H_INCLUDED
+#define MESHHASH_H_INCLUDED
+
+#include <cstdint>
+
+#include "FrozenMesh.h"
+
+// content hash of a mesh: coordinates, connectivity and area ids
+// (records are hashed one by one and summed, so the result doesn't depend on the
+// iteration order of the containers, an AneuMeshLoader and its FrozenMesh give the same digest)
+struct MeshDigest {
+	// hashes of the parts, equal parts give equal values
+	uint64_t _nodes{};
+	uint64_t _finiteElements{};
+	uint64_t _boundaryElements{};
+
+	// hash of the whole mesh (dimensions, amounts and the parts)
+	std::array<uint64_t, 2> _value{};
+
+	// 32 hex digits of _value, usable as a cache key or a file name
+	std::string hex() const;
+
+	bool operator == (const MeshDigest&) const = default;
+};
+
+// content hash of a loaded mesh (parallel over the hash buckets)
+MeshDigest hashMesh(const AneuMeshLoader&, ThreadPool& = ThreadPool::shared());
+
+// content hash of a snapshot (parallel)
+MeshDigest hashMesh(const FrozenMesh&, ThreadPool& = ThreadPool::shared());
+
+// differences between two meshes, records are matched by id, every list is sorted
+struct MeshDiff {
+	// node ids only in the second mesh / only in the first one / in both with other coordinates
+	std::vector<size_t> _addedNodes;
+	std::vector<size_t> _removedNodes;
+	std::vector<size_t> _movedNodes;
+
+	// element ids only in the second mesh / only in the first one / in both with other nodes or area id
+	std::vector<size_t> _addedFiniteElements;
+	std::vector<size_t> _removedFiniteElements;
+	std::vector<size_t> _changedFiniteElements;
+
+	std::vector<size_t> _addedBoundaryElements;
+	std::vector<size_t> _removedBoundaryElements;
+	std::vector<size_t> _changedBoundaryElements;
+
+	// true if the meshes are the same
+	bool empty() const;
+
+	// amounts of every kind of difference
+	void print(std::ostream&) const;
+};
+
+// structural diff from the first mesh to the second one,
+// a node is moved if one of its coordinates differs by more than tolerance
+MeshDiff diffMeshes(const AneuMeshLoader&, const AneuMeshLoader&, double tolerance = 0.0, ThreadPool& = ThreadPool::shared());
+
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+#ifndef MESHSERVER_H_INCLUDED
+#define MESHSERVER_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <set>
+
+#include "Writer.h"
+
+// local mesh daemon: every mesh is loaded once, published as a binary cache image in
+// POSIX shared memory and queried over a Unix domain socket (POSIX systems only,
+// elsewhere the constructors throw)
+//
+// protocol: one request per line, one response line "OK[ <payload>]" or "ERR <message>",
+// the mesh path is the rest of the line so it may contain spaces,
+// relative paths are resolved against the working directory of the server
+//   ATTACH <path>                load the mesh if needed -> <shared memory name> <bytes>
+//   EDGE <a> <b> <path>          finite element ids with the nodes a and b
+//   FACE <a> <b> <c> <path>      finite element ids with the vertex nodes a, b and c
+//   MATERIAL <id> <path>         finite element ids with a material id
+//   AREA <id> <path>             boundary element ids with a surface area id
+//   AREANODES <id> <path>        node ids of the boundary elements with a surface area id
+//   NEIGHBOURS <node> <path>     node ids sharing a finite element with the node
+//   STATS <path>                 all of the statistics as one line of JSON (*.neu / *.aneu only)
+//   LIST                         loaded meshes, "<shared memory name> <path>" separated by tabs
+//   SHUTDOWN                     stop the server after the response
+
+// settings for the mesh server
+struct MeshServerOptions {
+	// path of the Unix domain socket (a stale socket file is replaced)
+	std::string _socketPath;
+
+	// shared memory objects are named <prefix>-<server pid>-<counter>
+	std::string _sharedPrefix = "/aneu";
+
+	// settings for loading *.neu and *.aneu files
+	LoadOptions _load{};
+};
+
+// mesh daemon, requests of every connection are answered by a thread of its own,
+// the published meshes are immutable so the threads don't lock each other out
+class MeshServer {
+public:
+	// constructor (binds and listens on the socket)
+	explicit MeshServer(MeshServerOptions);
+
+	// destructor (stops the server, removes the socket and the shared memory objects,
+	// the mappings of attached clients stay valid)
+	~MeshServer();
+
+	MeshServer(const MeshServer&) = delete;
+	MeshServer& operator = (const MeshServer&) = delete;
+
+	// load and publish a mesh before the first request asks for it, returns the shared memory name
+	std::string preload(const std::string&);
+
+	// accept connections until SHUTDOWN or stop()
+	void run();
+
+	// make run() return (callable from any thread and from a request)
+	void stop();
+
+	// response to one request line (without the line end), also usable in-process
+	std::string answer(const std::string&);
+private:
+	struct Published;
+
+	// published mesh of a path, loaded by the first caller
+	Published& published(const std::string&);
+
+	// answer the requests of one connection until it is closed
+	void serve(int);
+
+	MeshServerOptions _options;
+	int _listener = -1;
+	int _wake[2] = { -1, -1 };
+	std::atomic<bool> _stopping{ false };
+
+	std::mutex _mutex;
+	std::map<std::string, std::shared_ptr<Published>> _meshes;
+	size_t _counter{};
+	std::set<int> _connections;
+	size_t _active{};
+	std::condition_variable _idle;
+};
+
+// mesh image of a server mapped read-only into this process (no copies are made)
+class AttachedMesh {
+public:
+	AttachedMesh(AttachedMesh&&) noexcept;
+	AttachedMesh& operator = (AttachedMesh&&) noexcept;
+	~AttachedMesh();
+
+	// structure of arrays view over the shared image
+	const BinaryMeshView& view() const { return _view; }
+
+	// name of the shared memory object
+	const std::string& name() const { return _name; }
+
+	// amount of mapped bytes
+	size_t size() const { return _size; }
+private:
+	friend class MeshClient;
+	AttachedMesh(const std::string&, size_t);
+
+	std::string _name;
+	const void* _data = nullptr;
+	size_t _size{};
+	BinaryMeshView _view;
+};
+
+// connection to a MeshServer, one request at a time
+class MeshClient {
+public:
+	// constructor (connects to the socket)
+	explicit MeshClient(const std::string&);
+	~MeshClient();
+
+	MeshClient(const MeshClient&) = delete;
+	MeshClient& operator = (const MeshClient&) = delete;
+
+	// send one request line and return the payload of the response (Exception for ERR)
+	std::string request(const std::string&);
+
+	// ask the server for a mesh and map its image read-only
+	AttachedMesh attach(const std::string&);
+
+	// finite element ids with an edge
+	std::vector<size_t> findFiniteElementsByEdges(const std::string&, size_t, size_t);
+
+	// finite element ids with 3 vertices
+	std::vector<size_t> findFiniteElementsByVertices(const std::string&, size_t, size_t, size_t);
+
+	// node ids sharing a finite element with a node
+	std::vector<size_t> neighbours(const std::string&, size_t);
+
+	// statistics of a mesh as JSON
+	std::string stats(const std::string&);
+private:
+	// request with a mesh path, the path is sent absolute
+	std::string meshRequest(const std::string&, const std::string&);
+
+	int _socket = -1;
+	std::string _buffer;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef PARTITION_H_INCLUDED
+#define PARTITION_H_INCLUDED
+
+#include "FrozenMesh.h"
+
+// element-to-element graph (neighbours share a face) in CSR form,
+// vertices are positions in getFiniteElements()
+struct DualGraph {
+	std::vector<size_t> _offsets;
+	std::vector<size_t> _adjacency;
+
+	// amount of vertices
+	size_t size() const { return _offsets.empty() ? 0 : _offsets.size() - 1; }
+
+	// neighbours of a vertex (sorted)
+	std::span<const size_t> neighbours(size_t i) const {
+		return { _adjacency.data() + _offsets[i], _offsets[i + 1] - _offsets[i] };
+	}
+};
+
+// local <-> global ids of one partition (local ids are 1..n in every list)
+struct PartitionMap {
+	size_t _part{};
+	size_t _parts{};
+
+	// _nodeGlobal[local id - 1] = global node id
+	std::vector<size_t> _nodeGlobal;
+
+	// _nodeOwner[local id - 1] = part owning the node (the smallest part using it)
+	std::vector<size_t> _nodeOwner;
+
+	// _elementGlobal[local id - 1] = global finite element id
+	std::vector<size_t> _elementGlobal;
+
+	// _boundaryGlobal[local id - 1] = global boundary element id
+	std::vector<size_t> _boundaryGlobal;
+
+	// local ids of halo (ghost) nodes, owned by another part
+	std::vector<size_t> _halo;
+};
+
+// build the dual graph through shared faces
+DualGraph buildDualGraph(const FrozenMesh&, ThreadPool& = ThreadPool::shared());
+
+// recursive coordinate bisection of the element centroids into a given amount of parts,
+// res[i] = part of getFiniteElements()[i]
+std::vector<size_t> partitionRCB(const FrozenMesh&, size_t, ThreadPool& = ThreadPool::shared());
+
+// amount of dual graph edges between different parts
+size_t edgeCut(const DualGraph&, const std::vector<size_t>&);
+
+// write <base>.part<k>.aneu (loadable by GatherDataBuilderAneu) and <base>.part<k>.map
+// for every part, boundary elements go to the part of their owning finite element
+// (Exception if the partition doesn't give every finite element a part below the count
+//  or if a boundary element is not a face of any finite element)
+std::vector<PartitionMap> writePartitions(const FrozenMesh&, 
+					  const std::vector<size_t>&, 
+					  size_t, 
+					  const std::string&);
+
+// read a *.map file written by writePartitions
+PartitionMap readPartitionMap(const std::string&);
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef READER_H_INCLUDED
+#define READER_H_INCLUDED
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <new>
+
+#include "Compression.h"
+
+// settings for the background file reader
+struct ReaderOptions {
+	// size of one buffer in bytes (rounded up to the alignment)
+	size_t _bufferSize = 1 << 20;
+
+	// amount of buffers shared between the I/O thread and the parser
+	size_t _bufferCount = 2;
+};
+
+// reader that fills aligned buffers on a background thread
+// while the parser consumes the previously filled one
+class BufferedReader {
+public:
+	// alignment of every buffer in bytes
+	static constexpr size_t alignment = 4096;
+
+	// constructor (starts the I/O thread), compressed streams are decompressed on it
+	explicit BufferedReader(std::istream&, const ReaderOptions& = {}, Compression = Compression::None);
+
+	// destructor (stops and joins the I/O thread)
+	~BufferedReader();
+
+	BufferedReader(const BufferedReader&) = delete;
+	BufferedReader& operator = (const BufferedReader&) = delete;
+
+	// read one line without the trailing '\n', false if nothing is left
+	bool getline(std::string&);
+
+	// amount of bytes handed to the parser so far
+	size_t bytesConsumed() const { return _consumed; }
+
+private:
+	// deleter for buffers allocated with alignment
+	struct AlignedDelete {
+		void operator()(char* ptr) const { ::operator delete[](ptr, std::align_val_t{ alignment }); }
+	};
+
+	struct Buffer {
+		std::unique_ptr<char[], AlignedDelete> _data;
+		size_t _size{};
+	};
+
+	// I/O thread body
+	void fill();
+
+	// give the current buffer back to the I/O thread
+	void release();
+
+	std::unique_ptr<ByteSource> _source;
+	size_t _bufferSize{};
+	std::vector<Buffer> _buffers;
+
+	std::mutex _mutex;
+	std::condition_variable _filledCV;
+	std::condition_variable _freedCV;
+	size_t _ready{};       // amount of filled buffers waiting for the parser
+	bool _finished{};      // I/O thread has reached the end of the stream
+	bool _stop{};          // parser asked the I/O thread to stop
+	std::exception_ptr _error;
+
+	size_t _current{};     // buffer the parser is reading from
+	size_t _position{};    // position in the current buffer
+	bool _holding{};       // parser owns the current buffer
+	size_t _consumed{};
+
+	std::thread _worker;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef REORDER_H_INCLUDED
+#define REORDER_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+class AneuMeshLoader;
+
+// strategy for renumbering nodes to improve memory locality
+enum class ReorderStrategy {
+	None,
+	ReverseCuthillMcKee, // bandwidth reduction over the node graph
+	Hilbert,             // Hilbert curve over node coordinates
+	Morton               // Morton (Z-order) curve over node coordinates
+};
+
+// permutation between original and new ids (new ids are 1..n)
+struct Permutation {
+	// _newToOld[new id - 1] = original id
+	std::vector<size_t> _newToOld;
+
+	// _oldToNew[original id] = new id
+	std::unordered_map<size_t, size_t> _oldToNew;
+
+	// new id for an original id
+	size_t toNew(size_t id) const { return _oldToNew.at(id); }
+
+	// original id for a new id
+	size_t toOld(size_t id) const { return _newToOld.at(id - 1); }
+
+	// fill _oldToNew from _newToOld
+	void buildInverse();
+};
+
+// renumbering of the nodes and the finite elements of a mesh
+struct Renumbering {
+	Permutation _nodes;
+	Permutation _finiteElements;
+};
+
+// compute renumbering with a strategy
+// (finite elements are ordered by their smallest new node id)
+Renumbering computeRenumbering(const AneuMeshLoader&, ReorderStrategy);
+
+// bandwidth of the node graph: max |id1 - id2| over nodes sharing a finite element
+size_t meshBandwidth(const AneuMeshLoader&);
+
+// profile of the node graph: sum over nodes of the distance to the farthest lower neighbour
+size_t meshProfile(const AneuMeshLoader&);
+
+#endif
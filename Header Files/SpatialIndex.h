@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef SPATIALINDEX_H_INCLUDED
+#define SPATIALINDEX_H_INCLUDED
+
+#include "FrozenMesh.h"
+
+// spatial index over a frozen mesh: k-d tree over the node coordinates
+// and a bounding volume hierarchy over the finite element boxes,
+// queries are const and can be called from many threads
+class SpatialIndex {
+public:
+	// constructor (bulk loads both trees, space dimension 1..3)
+	explicit SpatialIndex(std::shared_ptr<const FrozenMesh>);
+
+	// id of the nearest node to a point (0 if the mesh has no nodes)
+	size_t nearestNode(std::span<const double>) const;
+
+	// id of a finite element containing a point (0 if the point is outside of the mesh),
+	// simplices (also with midside nodes) are tested exactly, other elements by their box
+	size_t locatePoint(std::span<const double>, double tolerance = 1e-12) const;
+
+	// batched nearestNode, points are stored one after another (spaceDim() values each)
+	void nearestNodes(std::span<const double>, 
+			  std::vector<size_t>&, 
+			  ThreadPool& = ThreadPool::shared()) const;
+
+	// batched locatePoint, points are stored one after another (spaceDim() values each)
+	void locatePoints(std::span<const double>, 
+			  std::vector<size_t>&, 
+			  double tolerance = 1e-12, 
+			  ThreadPool& = ThreadPool::shared()) const;
+
+	// getter for a Space Dimension
+	size_t spaceDim() const { return _dim; }
+
+	// getter for the indexed mesh
+	const FrozenMesh& mesh() const { return *_mesh; }
+
+private:
+	struct Box {
+		std::array<double, 3> _min{};
+		std::array<double, 3> _max{};
+	};
+
+	struct BvhNode {
+		Box _box;
+		size_t _left{};   // inner node: children, leaf: first position in _bvhElements
+		size_t _right{};  // inner node: children, leaf: amount of elements
+		bool _leaf{};
+	};
+
+	// k-d tree build over [first, last) of _kdIds
+	void buildKd(size_t, size_t, size_t);
+
+	// k-d tree search over [first, last)
+	void searchKd(const double*, size_t, size_t, size_t, size_t&, double&) const;
+
+	// bvh build over [first, last) of _bvhElements, returns node index
+	size_t buildBvh(size_t, size_t);
+
+	// exact or box containment test of one element
+	bool contains(size_t, const double*, double) const;
+
+	std::shared_ptr<const FrozenMesh> _mesh;
+	size_t _dim{};
+
+	// k-d tree: node ids and coordinates in tree order
+	std::vector<size_t> _kdIds;
+	std::vector<double> _kdCoords;
+
+	// bvh: element positions in getFiniteElements() in leaf order
+	std::vector<BvhNode> _bvh;
+	std::vector<size_t> _bvhElements;
+	std::vector<Box> _elementBoxes;
+
+	// simplex vertex coordinates per element ((dim + 1) * dim values, empty if not a simplex)
+	std::vector<std::vector<double>> _simplices;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+// bounded pool of worker threads with a deque per worker,
+// idle workers steal tasks from the other deques
+class ThreadPool {
+public:
+	// constructor (0 threads = hardware concurrency)
+	explicit ThreadPool(size_t = 0);
+
+	// destructor (finishes queued tasks and joins the workers)
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator = (const ThreadPool&) = delete;
+
+	// queue a task (tasks submitted from a worker go to its own deque)
+	void submit(std::function<void()>);
+
+	// block until every submitted task has finished, the first exception thrown
+	// by a task since the last wait is rethrown here
+	void wait();
+
+	// split [0, count) into chunks and run body(chunk, begin, end) on the workers,
+	// the caller works on chunks too, so it may be called from a task as well
+	void parallelFor(size_t count, size_t chunks, const std::function<void(size_t, size_t, size_t)>& body);
+
+	// process-wide pool with hardware concurrency workers (or the amount given to configureShared)
+	static ThreadPool& shared();
+
+	// amount of workers of the shared pool (0 = hardware concurrency),
+	// only works before the first call to shared(), false afterwards
+	static bool configureShared(size_t);
+
+	// getter for amount of workers
+	size_t size() const { return _workers.size(); }
+
+private:
+	struct Queue {
+		std::mutex _mutex;
+		std::deque<std::function<void()>> _tasks;
+	};
+
+	// worker body
+	void run(size_t);
+
+	// take a task from own deque (back) or steal from another one (front)
+	bool pop(size_t, std::function<void()>&);
+
+	std::vector<std::unique_ptr<Queue>> _queues;
+	std::vector<std::thread> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _wakeCV;
+	std::condition_variable _idleCV;
+	size_t _queued{};   // tasks waiting in the deques
+	size_t _pending{};  // tasks submitted but not finished
+	bool _stop{};
+	std::exception_ptr _error; // first exception of a task, taken by wait()
+
+	std::atomic<size_t> _next{};
+};
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#ifndef WRITER_H_INCLUDED
+#define WRITER_H_INCLUDED
+
+#include <cstdint>
+#include <span>
+
+#include "FrozenMesh.h"
+
+// settings for the mesh writers
+struct WriterOptions {
+	// approximate size of one formatted chunk in bytes
+	size_t _bufferSize = 1 << 22;
+
+	// chunks formatted in parallel before they are written (0 = pool size, 1 = serial)
+	size_t _chunks = 0;
+
+	// end *.aneu lines with \r\n like the *.neu files do
+	bool _crlf = true;
+
+	// add the boundary elements as cells to the VTK output
+	bool _vtkBoundary = false;
+};
+
+// header of the binary cache format "ANEUBIN1"
+// (host byte order, every section starts at a 64 byte aligned offset from the beginning of the file)
+struct BinaryHeader {
+	char _magic[8];
+	uint64_t _spaceDimension;
+	uint64_t _nodes;
+	uint64_t _finiteElements;
+	uint64_t _nodesInFE;
+	uint64_t _boundaryElements;
+	uint64_t _nodesInBE;
+
+	// byte offsets of the sections:
+	// node ids (u64), coordinates (f64, one array per axis), vertex flags (u8),
+	// FE ids, FE material ids, FE node ids (u64, nodesInFE per element),
+	// BE ids, BE area ids, BE node ids (u64, nodesInBE per element)
+	uint64_t _sections[9];
+
+	// total size of the file in bytes
+	uint64_t _size;
+};
+
+// read-only structure of arrays view over a binary cache image
+// (the image must stay alive and 8 byte aligned while the view is used)
+struct BinaryMeshView {
+	size_t _spaceDimension{};
+	size_t _nodesInFE{};
+	size_t _nodesInBE{};
+
+	std::span<const uint64_t> _nodeIds;
+	std::span<const double> _coords;   // _coords[axis * nodes + i]
+	std::span<const uint8_t> _isVertex;
+
+	std::span<const uint64_t> _finiteElementIds;
+	std::span<const uint64_t> _materialIds;
+	std::span<const uint64_t> _finiteElementNodes;
+
+	std::span<const uint64_t> _boundaryElementIds;
+	std::span<const uint64_t> _surfaceIds;
+	std::span<const uint64_t> _boundaryElementNodes;
+
+	// check the header and the section bounds of an image
+	static BinaryMeshView parse(const void*, size_t);
+};
+
+// binary cache file read into memory
+struct BinaryMesh {
+	std::vector<uint64_t> _image;
+	BinaryMeshView _view;
+};
+
+// write a mesh as *.aneu (node and element ids are renumbered by position)
+void writeAneu(const FrozenMesh&, const std::string&, const WriterOptions& = {}, ThreadPool& = ThreadPool::shared());
+
+// amount of bytes of the binary cache image of a mesh
+size_t binaryImageSize(const FrozenMesh&);
+
+// write the binary cache image of a mesh into a buffer of at least binaryImageSize() bytes
+// (ids are kept, every block needs one amount of nodes)
+void writeBinaryImage(const FrozenMesh&, std::span<char>, const WriterOptions& = {}, ThreadPool& = ThreadPool::shared());
+
+// write a mesh in the binary cache format (ids are kept, every block needs one amount of nodes)
+void writeBinary(const FrozenMesh&, const std::string&, const WriterOptions& = {}, ThreadPool& = ThreadPool::shared());
+
+// read a file in the binary cache format
+BinaryMesh readBinary(const std::string&);
+
+// write the finite elements as a legacy binary VTK unstructured grid (*.vtk), the shapes may be mixed
+// (linear ones and the quadratic simplices of newNodesInEdges)
+void writeVtkLegacy(const FrozenMesh&, const std::string&, const WriterOptions& = {}, ThreadPool& = ThreadPool::shared());
+
+// write the finite elements as an XML VTK unstructured grid with raw appended data (*.vtu), the shapes may be mixed
+// (linear ones and the quadratic simplices of newNodesInEdges)
+void writeVtu(const FrozenMesh&, const std::string&, const WriterOptions& = {}, ThreadPool& = ThreadPool::shared());
+
+#endif
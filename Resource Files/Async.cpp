@@ -0,0 +1,68 @@
+#include "Async.h"
+
+// load a mesh file on a worker of the pool
+Task<std::unique_ptr<AneuMeshLoader>> loadMeshAsync(std::string path,
+						    LoadOptions options,
+						    CancellationToken token,
+						    std::function<void(const LoadProgress&)> progress,
+						    ThreadPool& pool) {
+	co_await resumeOn(pool);
+	if (token.cancelled()) throw OperationCancelled("Loading was cancelled: " + path);
+
+	// a callback already in the options can still stop the load
+	options._progress = [token, progress, previous = std::move(options._progress)](const LoadProgress& at) {
+		if (progress) progress(at);
+		if (previous && !previous(at)) return false;
+		return !token.cancelled();
+	};
+
+	std::shared_ptr<GatherDataBuilder> builder;
+	if (isNeuPath(path)) builder.reset(new GatherDataBuilderNeu({}, options));
+	else builder.reset(new GatherDataBuilderAneu({}, options));
+
+	GatherDataDirector director;
+	director.set_builder(builder);
+	try {
+		director.GatherData(path);
+	}
+	catch (const Exception&) {
+		if (token.cancelled()) throw OperationCancelled("Loading was cancelled: " + path);
+		throw;
+	}
+	co_return builder->Release();
+}
+
+// statistics of a mesh on a worker of the pool
+Task<std::shared_ptr<Statistics>> computeStatsAsync(const AneuMeshLoader& mesh,
+						    StatsMask mask,
+						    CancellationToken token,
+						    std::function<void(const StatsProgress&)> progress,
+						    ThreadPool& pool) {
+	co_await resumeOn(pool);
+
+	std::shared_ptr<StatsBuilder> builder(new StatsBuilder());
+	StatsDirector director;
+	director.set_builder(builder);
+
+	// parts with the amount of elements they go through,
+	// all of them at once share the traversals of the finite elements
+	size_t finite = mesh.sizeFiniteElements(), both = finite + mesh.sizeBoundaryElements();
+	std::vector<std::pair<std::function<void()>, size_t>> parts;
+	if (mask == StatsMask::All) parts.emplace_back([&] { director.CountAllStatisticsWithQuality(mesh); }, both);
+	else {
+		if (contains(mask, StatsMask::Areas)) parts.emplace_back([&] { director.CountAmountOfElementsByAreaId(mesh); }, both);
+		if (contains(mask, StatsMask::Nodes)) parts.emplace_back([&] { director.CountNodesInElements(mesh); }, both);
+		if (contains(mask, StatsMask::Common)) parts.emplace_back([&] { director.CountCommonNodesInElements(mesh); }, both);
+		if (contains(mask, StatsMask::Quality)) parts.emplace_back([&] { director.CountMeshQuality(mesh); }, finite);
+	}
+
+	StatsProgress at{};
+	for (const auto& part : parts) at._totalElements += part.second;
+	for (const auto& [run, elements] : parts) {
+		if (token.cancelled()) throw OperationCancelled("Computing the statistics was cancelled");
+		run();
+		at._elements += elements;
+		if (progress) progress(at);
+	}
+	co_return builder->GetStat();
+}
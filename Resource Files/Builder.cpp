@@ -1,4 +1,10 @@
 #include "Builder.h"
+#include "Faces.h"
+#include "FrozenMesh.h"
+
+#include <filesystem>
+#include <map>
+#include <string_view>
 
 // display data
 void Statistics::ShowData() const {
@@ -74,17 +80,119 @@ void Statistics::ShowData() const {
         std::cout << std::endl;
     }
 
+    if (_qualityIsInitialized) {
+        std::cout << "mesh quality of finite elements with each material area id" << std::endl;
+        std::cout << "edge length histogram range: [" 
+                  << _edgeHistogramMin << ", " 
+                  << _edgeHistogramMax << "]" 
+                  << std::endl;
+        for (const auto& el : _qualityFEareaId) {
+            const QualityStats& q = el.second;
+            std::cout << el.first 
+                      << std::setw(digitsFormatingHelper3(el.first)) 
+                      << " : elements = " << q._elements 
+                      << "; aspect ratio = [" << q._minAspectRatio << ", " << q._maxAspectRatio << "]" 
+                      << "; angle = [" << q._minAngle << ", " << q._maxAngle << "]" 
+                      << "; edge = [" << q._minEdge << ", " << q._maxEdge << "]" 
+                      << "; degenerate = " << q._degenerate 
+                      << "; inverted = " << q._inverted 
+                      << std::endl;
+            std::cout << "    edge length histogram: { ";
+            std::ranges::copy(q._edgeHistogram, std::ostream_iterator<size_t>(std::cout, " "));
+            std::cout << "}" << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
     if (!(_amountFEareaIdIsInitialized ||
         _amountBEareaIdIsInitialized   ||
         _amountFENodeIsInitialized     ||
         _amountBENodeIsInitialized     ||
         _commonNodeFEIsInitialized     ||
-        _commonNodeBEIsInitialized)) std::cout << "No statistics were loaded" << std::endl;
+        _commonNodeBEIsInitialized     ||
+        _qualityIsInitialized)) std::cout << "No statistics were loaded" << std::endl;
+}
+
+// write the loaded statistics as one JSON object
+void Statistics::WriteJson(std::ostream& output) const {
+    std::streamsize precision = output.precision(std::numeric_limits<double>::max_digits10);
+    const char* separator = "";
+    auto key = [&](const std::string& name) {
+        output << separator << '"' << name << "\":";
+        separator = ",";
+    };
+    auto number = [&output](double value) {
+        if (std::isfinite(value)) output << value;
+        else output << "null";
+    };
+    auto amounts = [&](const std::unordered_map<size_t, size_t>& values) {
+        output << '{';
+        separator = "";
+        for (const auto& [id, amount] : std::map<size_t, size_t>(begin(values), end(values))) {
+            key(std::to_string(id));
+            output << amount;
+        }
+        output << '}';
+        separator = ",";
+    };
+    auto range = [&](double min, double max) {
+        output << '[';
+        number(min);
+        output << ',';
+        number(max);
+        output << ']';
+    };
+
+    output << '{';
+    if (_amountFEareaIdIsInitialized) { key("finiteElementsByMaterial"); amounts(_amountFEareaId); }
+    if (_amountBEareaIdIsInitialized) { key("boundaryElementsBySurface"); amounts(_amountBEareaId); }
+    if (_amountFENodeIsInitialized) { key("finiteElementNodeUse"); amounts(_amountFENode); }
+    if (_amountBENodeIsInitialized) { key("boundaryElementNodeUse"); amounts(_amountBENode); }
+    if (_commonNodeFEIsInitialized) {
+        key("commonNodeFE");
+        output << "{\"id\":" << _commonNodeFE.first << ",\"amount\":" << _commonNodeFE.second << '}';
+    }
+    if (_commonNodeBEIsInitialized) {
+        key("commonNodeBE");
+        output << "{\"id\":" << _commonNodeBE.first << ",\"amount\":" << _commonNodeBE.second << '}';
+    }
+    if (_qualityIsInitialized) {
+        key("quality");
+        output << "{\"edgeHistogramRange\":";
+        range(_edgeHistogramMin, _edgeHistogramMax);
+        output << ",\"materials\":{";
+        separator = "";
+        for (const auto& [id, q] : std::map<size_t, QualityStats>(begin(_qualityFEareaId), end(_qualityFEareaId))) {
+            key(std::to_string(id));
+            output << "{\"elements\":" << q._elements << ",\"aspectRatio\":";
+            range(q._minAspectRatio, q._maxAspectRatio);
+            output << ",\"angle\":";
+            range(q._minAngle, q._maxAngle);
+            output << ",\"edge\":";
+            range(q._minEdge, q._maxEdge);
+            output << ",\"degenerate\":" << q._degenerate << ",\"inverted\":" << q._inverted << ",\"edgeHistogram\":[";
+            for (size_t i = 0; i < q._edgeHistogram.size(); ++i) output << (i ? "," : "") << q._edgeHistogram[i];
+            output << "]}";
+        }
+        output << "}}";
+    }
+    output << '}' << std::endl;
+    output.precision(precision);
+}
+
+// true for *.neu, *.neu.gz and *.neu.zst paths
+bool isNeuPath(const std::string& path) {
+    for (const char* ext : { ".neu", ".neu.gz", ".neu.zst" }) {
+        std::string_view suffix(ext);
+        if (path.size() >= suffix.size() &&
+            path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) return true;
+    }
+    return false;
 }
 
 // fill _amountFEareaId
-void StatsBuilder::CountFEByAreaId(std::shared_ptr<AneuMeshLoader> obj) const {
-    for (const FiniteElement& FE : obj->getFiniteElements()) {
+void StatsBuilder::CountFEByAreaId(const AneuMeshLoader& obj) const {
+    for (const FiniteElement& FE : obj.finiteElementsSet()) {
         if (_stats->_amountFEareaId.count(FE._material_area_id))
             _stats->_amountFEareaId[FE._material_area_id]++;
         else _stats->_amountFEareaId[FE._material_area_id] = 1;
@@ -93,8 +201,8 @@ void StatsBuilder::CountFEByAreaId(std::shared_ptr<AneuMeshLoader> obj) const {
 }
 
 // fill _amountBEareaId
-void StatsBuilder::CountBEByAreaId(std::shared_ptr<AneuMeshLoader> obj) const {
-    for (const BoundaryElement& BE : obj->getBoundaryElements()) {
+void StatsBuilder::CountBEByAreaId(const AneuMeshLoader& obj) const {
+    for (const BoundaryElement& BE : obj.boundaryElementsSet()) {
         if (_stats->_amountBEareaId.count(BE._surface_area_id))
             _stats->_amountBEareaId[BE._surface_area_id]++;
         else _stats->_amountBEareaId[BE._surface_area_id] = 1;
@@ -103,8 +211,8 @@ void StatsBuilder::CountBEByAreaId(std::shared_ptr<AneuMeshLoader> obj) const {
 }
 
 // fill _amountFENode
-void StatsBuilder::CountNodesFE(std::shared_ptr<AneuMeshLoader> obj) const {
-    for (const FiniteElement& FE : obj->getFiniteElements()) {
+void StatsBuilder::CountNodesFE(const AneuMeshLoader& obj) const {
+    for (const FiniteElement& FE : obj.finiteElementsSet()) {
         for (const size_t& id : FE._nodeIDvec) {
             if (_stats->_amountFENode.count(id))
                 _stats->_amountFENode[id]++;
@@ -115,8 +223,8 @@ void StatsBuilder::CountNodesFE(std::shared_ptr<AneuMeshLoader> obj) const {
 }
 
 // fill _amountBENode
-void StatsBuilder::CountNodesBE(std::shared_ptr<AneuMeshLoader> obj) const {
-    for (const BoundaryElement& BE : obj->getBoundaryElements()) {
+void StatsBuilder::CountNodesBE(const AneuMeshLoader& obj) const {
+    for (const BoundaryElement& BE : obj.boundaryElementsSet()) {
         for (const size_t& id : BE._nodeIDvec) {
             if (_stats->_amountBENode.count(id))
                 _stats->_amountBENode[id]++;
@@ -126,70 +234,428 @@ void StatsBuilder::CountNodesBE(std::shared_ptr<AneuMeshLoader> obj) const {
     _stats->_amountBENodeIsInitialized = true;
 }
 
+namespace {
+
+// node with the most occurrences, ties go to the smallest node id ({0, 0} without nodes)
+std::pair<size_t, size_t> mostCommonNode(const std::unordered_map<size_t, size_t>& amounts) {
+    using pair_type = std::unordered_map<size_t, size_t>::value_type;
+    const auto pair = std::ranges::max_element(amounts,
+        [](const pair_type& p1,
+            const pair_type& p2) {
+                return p1.second < p2.second ||
+                       (p1.second == p2.second && p1.first > p2.first);});
+    if (pair == end(amounts)) return { 0, 0 };
+    return { pair->first, pair->second };
+}
+
+} // namespace
+
 // fill _commonNodeFE
-void StatsBuilder::CommonNodeFE(std::shared_ptr<AneuMeshLoader> obj) const {
-    if (_stats->_amountFENodeIsInitialized) {
-        using pair_type = decltype(_stats->_amountFENode)::value_type;
-        const auto pair = std::ranges::max_element(_stats->_amountFENode,
-            [](const pair_type& p1,
-                const pair_type& p2) {
-                    return p1.second < p2.second;});
-        _stats->_commonNodeFE = { pair->first, pair->second };
-        _stats->_commonNodeFEIsInitialized = true;
-        return;
-    }
-
-    size_t maxim = std::numeric_limits<size_t>::min();
-    size_t maxNodeId;
-    std::unordered_map<size_t, size_t> temp_umap;
-
-    for (const FiniteElement& FE : obj->getFiniteElements()) {
-        for (const size_t& id : FE._nodeIDvec) {
-            if (temp_umap.count(id)) {
-                temp_umap[id]++;
-                if (temp_umap[id] > maxim) {
-                    maxim = temp_umap[id];
-                    maxNodeId = id;
+void StatsBuilder::CommonNodeFE(const AneuMeshLoader& obj) const {
+    if (_stats->_amountFENodeIsInitialized) _stats->_commonNodeFE = mostCommonNode(_stats->_amountFENode);
+    else {
+        std::unordered_map<size_t, size_t> temp_umap;
+        for (const FiniteElement& FE : obj.finiteElementsSet())
+            for (const size_t& id : FE._nodeIDvec) temp_umap[id]++;
+        _stats->_commonNodeFE = mostCommonNode(temp_umap);
+    }
+    _stats->_commonNodeFEIsInitialized = true;
+}
+
+// fill _commonNodeBE
+void StatsBuilder::CommonNodeBE(const AneuMeshLoader& obj) const {
+    if (_stats->_amountBENodeIsInitialized) _stats->_commonNodeBE = mostCommonNode(_stats->_amountBENode);
+    else {
+        std::unordered_map<size_t, size_t> temp_umap;
+        for (const BoundaryElement& BE : obj.boundaryElementsSet())
+            for (const size_t& id : BE._nodeIDvec) temp_umap[id]++;
+        _stats->_commonNodeBE = mostCommonNode(temp_umap);
+    }
+    _stats->_commonNodeBEIsInitialized = true;
+}
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+using Vec3 = std::array<double, 3>;
+
+Vec3 sub(const Vec3& a, const Vec3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+
+double dot(const Vec3& a, const Vec3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+Vec3 cross(const Vec3& a, const Vec3& b) {
+    return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+
+double angle(const Vec3& a, const Vec3& b) {
+    double norms = std::sqrt(dot(a, a) * dot(b, b));
+    if (norms == 0) return 0;
+    return std::acos(std::clamp(dot(a, b) / norms, -1.0, 1.0)) * 180 / pi;
+}
+
+// quality of one element
+struct ElementQuality {
+    double _aspectRatio{};
+    double _minAngle = 180;
+    double _maxAngle{};
+    double _signedMeasure{}; // sign follows the vertex orientation (always + for triangles in 3D)
+    bool _degenerate{};
+    std::array<double, 12> _edges{};
+    size_t _edgeCount{};
+};
+
+// corner coordinates of an element, unused axes are 0
+using Corners = std::array<Vec3, 8>;
+
+// quality kernel of one shape
+using QualityKernel = ElementQuality (*)(const Corners&, size_t);
+
+// relative size below which an element is degenerate
+constexpr double degenerateTolerance = 1e-12;
+
+ElementQuality triangleQuality(const Corners& p, size_t dim) {
+    ElementQuality q{};
+    Vec3 e[3] = { sub(p[1], p[0]), sub(p[2], p[1]), sub(p[0], p[2]) };
+
+    double maxEdge = 0, perimeter = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        q._edges[i] = std::sqrt(dot(e[i], e[i]));
+        maxEdge = std::max(maxEdge, q._edges[i]);
+        perimeter += q._edges[i];
+    }
+    q._edgeCount = 3;
+
+    Vec3 normal = cross(e[0], sub(p[2], p[0]));
+    double area = std::sqrt(dot(normal, normal)) / 2;
+    q._signedMeasure = dim == 2 ? normal[2] / 2 : area;
+    q._degenerate = area <= degenerateTolerance * maxEdge * maxEdge;
+
+    // interior angles between the edges meeting at each vertex
+    for (size_t i = 0; i < 3; ++i) {
+        Vec3 back{ -e[(i + 2) % 3][0], -e[(i + 2) % 3][1], -e[(i + 2) % 3][2] };
+        double a = angle(e[i], back);
+        q._minAngle = std::min(q._minAngle, a);
+        q._maxAngle = std::max(q._maxAngle, a);
+    }
+
+    // 1 for the equilateral triangle
+    q._aspectRatio = q._degenerate ? std::numeric_limits<double>::infinity()
+                                   : maxEdge * perimeter / (4 * std::sqrt(3.0) * area);
+    return q;
+}
+
+ElementQuality tetrahedronQuality(const Corners& p, size_t) {
+    ElementQuality q{};
+    constexpr size_t edges[6][4] = { { 0, 1, 2, 3 }, { 0, 2, 1, 3 }, { 0, 3, 1, 2 },
+                                     { 1, 2, 0, 3 }, { 1, 3, 0, 2 }, { 2, 3, 0, 1 } };
+
+    double maxEdge = 0;
+    for (size_t i = 0; i < 6; ++i) {
+        const size_t* edge = edges[i];
+        Vec3 along = sub(p[edge[1]], p[edge[0]]);
+        q._edges[i] = std::sqrt(dot(along, along));
+        maxEdge = std::max(maxEdge, q._edges[i]);
+
+        // dihedral angle between the two faces sharing the edge
+        Vec3 n1 = cross(along, sub(p[edge[2]], p[edge[0]]));
+        Vec3 n2 = cross(along, sub(p[edge[3]], p[edge[0]]));
+        double a = angle(n1, n2);
+        q._minAngle = std::min(q._minAngle, a);
+        q._maxAngle = std::max(q._maxAngle, a);
+    }
+    q._edgeCount = 6;
+
+    Vec3 a = sub(p[1], p[0]), b = sub(p[2], p[0]), c = sub(p[3], p[0]);
+    q._signedMeasure = dot(a, cross(b, c)) / 6;
+    double volume = std::abs(q._signedMeasure);
+    q._degenerate = volume <= degenerateTolerance * maxEdge * maxEdge * maxEdge;
+
+    double faces = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        Vec3 normal = cross(sub(p[(i + 2) % 4], p[(i + 1) % 4]), sub(p[(i + 3) % 4], p[(i + 1) % 4]));
+        faces += std::sqrt(dot(normal, normal)) / 2;
+    }
+
+    // 1 for the regular tetrahedron (longest edge over 2 * sqrt(6) * inradius)
+    q._aspectRatio = q._degenerate ? std::numeric_limits<double>::infinity()
+                                   : maxEdge / (2 * std::sqrt(6.0) * (3 * volume / faces));
+    return q;
+}
+
+// quadrilaterals, pyramids, prisms and hexahedra: the aspect ratio is the longest edge over the
+// shortest one (1 for the square and the cube), the angles are the corner angles of the faces
+template <ElementType Type>
+ElementQuality shapeQuality(const Corners& p, size_t dim) {
+    ElementQuality q{};
+
+    double minEdge = std::numeric_limits<double>::max(), maxEdge = 0;
+    for (const std::array<uint8_t, 2>& edge : localEdges(Type)) {
+        Vec3 along = sub(p[edge[1]], p[edge[0]]);
+        double length = std::sqrt(dot(along, along));
+        q._edges[q._edgeCount++] = length;
+        minEdge = std::min(minEdge, length);
+        maxEdge = std::max(maxEdge, length);
+    }
+
+    q._signedMeasure = signedMeasure(Type, p, dim);
+    double scale = elementDimension(Type) == 3 ? maxEdge * maxEdge * maxEdge : maxEdge * maxEdge;
+    q._degenerate = std::abs(q._signedMeasure) <= degenerateTolerance * scale;
+
+    auto corners = [&](const std::vector<size_t>& face) {
+        for (size_t i = 0; i < face.size(); ++i) {
+            const Vec3& at = p[face[i]];
+            double a = angle(sub(p[face[(i + 1) % face.size()]], at), sub(p[face[(i + face.size() - 1) % face.size()]], at));
+            q._minAngle = std::min(q._minAngle, a);
+            q._maxAngle = std::max(q._maxAngle, a);
+        }
+    };
+    if constexpr (Type == ElementType::Quadrilateral) corners({ 0, 1, 2, 3 });
+    else for (const std::vector<size_t>& face : localFaces(3, vertexCount(Type))) corners(face);
+
+    q._aspectRatio = q._degenerate || minEdge == 0 ? std::numeric_limits<double>::infinity() : maxEdge / minEdge;
+    return q;
+}
+
+// quality kernel of a shape (nullptr if it isn't measured)
+QualityKernel qualityKernel(ElementType type) {
+    switch (type) {
+    case ElementType::Triangle: return triangleQuality;
+    case ElementType::Quadrilateral: return shapeQuality<ElementType::Quadrilateral>;
+    case ElementType::Tetrahedron: return tetrahedronQuality;
+    case ElementType::Pyramid: return shapeQuality<ElementType::Pyramid>;
+    case ElementType::Prism: return shapeQuality<ElementType::Prism>;
+    case ElementType::Hexahedron: return shapeQuality<ElementType::Hexahedron>;
+    default: return nullptr;
+    }
+}
+
+} // namespace
+
+// fill _qualityFEareaId
+void StatsBuilder::MeshQuality(const AneuMeshLoader& obj) const {
+    TraverseFE(obj, false);
+}
+
+// fill _amountFEareaId, _amountFENode, _commonNodeFE and _qualityFEareaId together
+void StatsBuilder::CountFEWithQuality(const AneuMeshLoader& obj) const {
+    TraverseFE(obj, true);
+    CommonNodeFE(obj); // uses _amountFENode, no second traversal
+}
+
+// shared part of MeshQuality and CountFEWithQuality,
+// costs a FrozenMesh of obj (a copy of the mesh sorted by id, for the node lookups and the
+// shape buckets), one parallel pass over the finite elements for everything but the edge
+// length histograms, and a second one recomputing only the edge lengths once their range is known
+void StatsBuilder::TraverseFE(const AneuMeshLoader& obj, bool counts) const {
+    FrozenMesh mesh(obj);
+    size_t dim = mesh.spaceDim();
+
+    // per chunk results, merged after the traversal
+    struct Partial {
+        std::unordered_map<size_t, size_t> _areas;
+        std::unordered_map<size_t, size_t> _nodes;
+        std::unordered_map<size_t, QualityStats> _quality;
+        std::unordered_map<size_t, std::pair<size_t, size_t>> _orientation; // {positive, negative}
+        std::unordered_map<size_t, std::vector<size_t>> _histograms;
+    };
+
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<Partial> partials(pool.size() * 4);
+
+    // shapes of the space dimension only
+    auto kernelOf = [&](const ElementBucket& bucket) {
+        return elementDimension(bucket._type) == dim ? qualityKernel(bucket._type) : nullptr;
+    };
+
+    // corner coordinates of an element (false if a node is missing), midside nodes follow the vertices
+    auto cornersOf = [&](const ElementBucket& bucket, std::span<const size_t> ids, Corners& p) {
+        for (size_t v = 0; v < vertexCount(bucket._type); ++v) {
+            const Node* node = mesh.findNode(ids[v]);
+            if (!node) return false;
+            for (size_t d = 0; d < dim; ++d) p[v][d] = node->_coords[d];
+        }
+        return true;
+    };
+
+    // one bucket after another, every bucket with the kernel of its shape
+    for (const ElementBucket& bucket : mesh.finiteBuckets()._buckets) {
+        QualityKernel kernel = kernelOf(bucket);
+
+        pool.parallelFor(bucket.size(), partials.size(), [&](size_t chunk, size_t first, size_t last) {
+            Partial& partial = partials[chunk];
+
+            for (size_t k = first; k < last; ++k) {
+                size_t material = bucket._areaIds[k];
+                std::span<const size_t> ids = bucket.nodes(k);
+                if (counts) {
+                    partial._areas[material]++;
+                    for (const size_t& id : ids) partial._nodes[id]++;
+                }
+                if (!kernel) continue;
+
+                Corners p{};
+                if (!cornersOf(bucket, ids, p)) continue;
+
+                ElementQuality q = kernel(p, dim);
+                QualityStats& stats = partial._quality[material];
+                stats._elements++;
+                if (q._degenerate) stats._degenerate++;
+                else {
+                    stats._minAspectRatio = std::min(stats._minAspectRatio, q._aspectRatio);
+                    stats._maxAspectRatio = std::max(stats._maxAspectRatio, q._aspectRatio);
+                }
+                stats._minAngle = std::min(stats._minAngle, q._minAngle);
+                stats._maxAngle = std::max(stats._maxAngle, q._maxAngle);
+
+                auto& orientation = partial._orientation[material];
+                if (q._signedMeasure > 0) orientation.first++;
+                if (q._signedMeasure < 0) orientation.second++;
+
+                for (size_t e = 0; e < q._edgeCount; ++e) {
+                    stats._minEdge = std::min(stats._minEdge, q._edges[e]);
+                    stats._maxEdge = std::max(stats._maxEdge, q._edges[e]);
                 }
             }
-            else temp_umap[id] = 1;
+        });
+    }
+
+    // merge
+    std::unordered_map<size_t, std::pair<size_t, size_t>> orientation;
+    size_t positive = 0, negative = 0;
+    double minEdge = std::numeric_limits<double>::max(), maxEdge = 0;
+
+    for (Partial& partial : partials) {
+        for (const auto& [id, amount] : partial._areas) _stats->_amountFEareaId[id] += amount;
+        for (const auto& [id, amount] : partial._nodes) _stats->_amountFENode[id] += amount;
+
+        for (const auto& [id, q] : partial._quality) {
+            QualityStats& stats = _stats->_qualityFEareaId[id];
+            stats._elements += q._elements;
+            stats._degenerate += q._degenerate;
+            stats._minAspectRatio = std::min(stats._minAspectRatio, q._minAspectRatio);
+            stats._maxAspectRatio = std::max(stats._maxAspectRatio, q._maxAspectRatio);
+            stats._minAngle = std::min(stats._minAngle, q._minAngle);
+            stats._maxAngle = std::max(stats._maxAngle, q._maxAngle);
+            stats._minEdge = std::min(stats._minEdge, q._minEdge);
+            stats._maxEdge = std::max(stats._maxEdge, q._maxEdge);
+            minEdge = std::min(minEdge, q._minEdge);
+            maxEdge = std::max(maxEdge, q._maxEdge);
+        }
+
+        for (const auto& [id, o] : partial._orientation) {
+            orientation[id].first += o.first;
+            orientation[id].second += o.second;
+            positive += o.first;
+            negative += o.second;
         }
     }
 
-    _stats->_commonNodeFE = { maxim, maxNodeId };
-    _stats->_commonNodeFEIsInitialized = true;
+    // meshers differ in vertex ordering, the orientation of the majority is taken as valid
+    for (const auto& [id, o] : orientation)
+        _stats->_qualityFEareaId[id]._inverted = positive >= negative ? o.second : o.first;
+
+    if (minEdge > maxEdge) minEdge = maxEdge = 0;
+    _stats->_edgeHistogramMin = minEdge;
+    _stats->_edgeHistogramMax = maxEdge;
+    for (auto& [id, stats] : _stats->_qualityFEareaId) stats._edgeHistogram.assign(histogramBins, 0);
+
+    // the bins need the range of all of the edges, so the edge lengths are computed again
+    // instead of being kept from the first pass (the same lengths, the edges in another order)
+    double width = (maxEdge - minEdge) / histogramBins;
+    for (const ElementBucket& bucket : mesh.finiteBuckets()._buckets) {
+        if (!kernelOf(bucket)) continue;
+
+        pool.parallelFor(bucket.size(), partials.size(), [&](size_t chunk, size_t first, size_t last) {
+            Partial& partial = partials[chunk];
+
+            for (size_t k = first; k < last; ++k) {
+                Corners p{};
+                if (!cornersOf(bucket, bucket.nodes(k), p)) continue;
+
+                std::vector<size_t>& histogram = partial._histograms[bucket._areaIds[k]];
+                if (histogram.empty()) histogram.assign(histogramBins, 0);
+                for (const std::array<uint8_t, 2>& edge : localEdges(bucket._type)) {
+                    Vec3 along = sub(p[edge[1]], p[edge[0]]);
+                    double length = std::sqrt(dot(along, along));
+                    size_t bin = width > 0 ? static_cast<size_t>((length - minEdge) / width) : 0;
+                    histogram[std::min(bin, histogramBins - 1)]++;
+                }
+            }
+        });
+    }
+
+    for (const Partial& partial : partials)
+        for (const auto& [id, histogram] : partial._histograms)
+            for (size_t bin = 0; bin < histogramBins; ++bin)
+                _stats->_qualityFEareaId[id]._edgeHistogram[bin] += histogram[bin];
+
+    if (counts) {
+        _stats->_amountFEareaIdIsInitialized = true;
+        _stats->_amountFENodeIsInitialized = true;
+    }
+    _stats->_qualityIsInitialized = true;
 }
 
-// fill _commonNodeBE
-void StatsBuilder::CommonNodeBE(std::shared_ptr<AneuMeshLoader> obj) const {
-    if (_stats->_amountBENodeIsInitialized) {
-        using pair_type = decltype(_stats->_amountBENode)::value_type;
-        const auto pair = std::ranges::max_element(_stats->_amountBENode,
-            [](const pair_type& p1,
-                const pair_type& p2) {
-                    return p1.second < p2.second;});
-        _stats->_commonNodeBE = { pair->first, pair->second };
-        _stats->_commonNodeBEIsInitialized = true;
-        return;
-    }
-
-    size_t maxim = std::numeric_limits<size_t>::min();
-    size_t maxNodeId;
-    std::unordered_map<size_t, size_t> temp_umap;
-
-    for (const BoundaryElement& BE : obj->getBoundaryElements()) {
-        for (const size_t& id : BE._nodeIDvec) {
-            if (temp_umap.count(id)) {
-                temp_umap[id]++;
-                if (temp_umap[id] > maxim) {
-                    maxim = temp_umap[id];
-                    maxNodeId = id;
+// load many files concurrently, consumer gets every result as soon as it is ready
+void GatherDataDirector::GatherDataBatch(const std::vector<std::string>&            paths,
+                                         const std::function<void(BatchResult&&)>&  consumer,
+                                         size_t                                     threads,
+                                         bool                                       countStatistics,
+                                         const ReaderOptions&                       options) {
+    // loading a *.neu file writes an *.aneu (see NeuToAneuPath), *.neu paths that lead to
+    // the same *.aneu (m.neu and ./m.neu, a\m.neu and b\m.neu) must not be loaded at the same time
+    auto aneuKey = [](const std::string& path) {
+        return std::filesystem::absolute(AneuMeshLoader::NeuToAneuPath(path)).lexically_normal().string();
+    };
+    std::map<std::string, std::mutex> neuMutexes;
+    for (const std::string& path : paths)
+        if (isNeuPath(path)) neuMutexes[aneuKey(path)];
+
+    std::mutex consumerMutex;
+    ThreadPool pool(threads ? std::min(threads, paths.size()) : 0);
+
+    for (const std::string& path : paths) {
+        pool.submit([&, path] {
+            BatchResult result{};
+            result._path = path;
+
+            try {
+                std::shared_ptr<GatherDataBuilder> builder;
+                std::unique_lock<std::mutex> neuLock;
+                if (isNeuPath(path)) {
+                    builder.reset(new GatherDataBuilderNeu(options));
+                    neuLock = std::unique_lock<std::mutex>(neuMutexes.at(aneuKey(path)));
+                }
+                else builder.reset(new GatherDataBuilderAneu(options));
+
+                GatherDataDirector gdDirector;
+                gdDirector.set_builder(builder);
+                gdDirector.GatherData(path);
+                result._mesh = builder->Release();
+                if (neuLock) neuLock.unlock();
+
+                if (countStatistics) {
+                    std::shared_ptr<StatsBuilder> statsBuilder(new StatsBuilder());
+                    StatsDirector sDirector;
+                    sDirector.set_builder(statsBuilder);
+                    sDirector.CountAllStatistics(*result._mesh);
+                    result._stats = statsBuilder->GetStat();
                 }
             }
-            else temp_umap[id] = 1;
-        }
+            catch (const Exception& e) {
+                result._mesh.reset();
+                result._error = e.what();
+            }
+            catch (const std::exception& e) {
+                result._mesh.reset();
+                result._error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(consumerMutex);
+            consumer(std::move(result));
+        });
     }
 
-    _stats->_commonNodeBE = { maxim, maxNodeId };
-    _stats->_commonNodeBEIsInitialized = true;
+    pool.wait();
 }
@@ -0,0 +1,145 @@
+#include "Coloring.h"
+
+namespace {
+
+// value used for an element without a color yet
+constexpr size_t uncolored = static_cast<size_t>(-1);
+
+// call visit(other) for every element sharing a node with the element (it may repeat)
+template <class Visit>
+void forEachNeighbour(const FrozenMesh& mesh, size_t element, Visit visit) {
+	for (const size_t& id : mesh.getFiniteElements()[element]._nodeIDvec) {
+		size_t node = mesh.nodeIndex(id);
+		if (node == FrozenMesh::npos) continue;
+		for (const size_t& other : mesh.elementsOfNode(node))
+			if (other != element) visit(other);
+	}
+}
+
+// smallest color not used by the colored neighbours,
+// used[c] == stamp marks the colors taken around the current element
+size_t firstFreeColor(const FrozenMesh& mesh, const std::vector<size_t>& colors, size_t element, std::vector<size_t>& used) {
+	forEachNeighbour(mesh, element, [&](size_t other) {
+		size_t c = colors[other];
+		if (c == uncolored) return;
+		if (c >= used.size()) used.resize(c + 1, uncolored);
+		used[c] = element;
+	});
+
+	size_t res = 0;
+	while (res < used.size() && used[res] == element) res++;
+	return res;
+}
+
+// random but reproducible weight of an element (splitmix64)
+uint64_t weight(size_t element) {
+	uint64_t x = element + 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+void colorGreedy(const FrozenMesh& mesh, std::vector<size_t>& colors) {
+	std::vector<size_t> used;
+	for (size_t element = 0; element < colors.size(); ++element)
+		colors[element] = firstFreeColor(mesh, colors, element, used);
+}
+
+// every round colors the uncolored elements whose weight is the largest among
+// their uncolored neighbours, such elements are never neighbours of each other
+void colorJonesPlassmann(const FrozenMesh& mesh, std::vector<size_t>& colors, ThreadPool& pool) {
+	std::vector<size_t> remaining(colors.size());
+	std::iota(begin(remaining), end(remaining), 0);
+	std::vector<char> selected(colors.size());
+	std::vector<uint64_t> weights(colors.size());
+	for (size_t element = 0; element < colors.size(); ++element) weights[element] = weight(element);
+
+	while (!remaining.empty()) {
+		// selection only reads the colors of the previous rounds
+		pool.parallelFor(remaining.size(), 0, [&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				size_t element = remaining[i];
+				auto key = std::pair(weights[element], element);
+				bool maximum = true;
+				forEachNeighbour(mesh, element, [&](size_t other) {
+					if (colors[other] == uncolored && std::pair(weights[other], other) > key) maximum = false;
+				});
+				selected[element] = maximum;
+			}
+		});
+
+		pool.parallelFor(remaining.size(), 0, [&](size_t, size_t begin, size_t end) {
+			std::vector<size_t> used;
+			for (size_t i = begin; i < end; ++i) {
+				size_t element = remaining[i];
+				if (selected[element]) colors[element] = firstFreeColor(mesh, colors, element, used);
+			}
+		});
+
+		std::erase_if(remaining, [&colors](size_t element) { return colors[element] != uncolored; });
+	}
+}
+
+} // namespace
+
+// color the finite elements over the node -> element incidence
+ElementColoring colorElements(const FrozenMesh& mesh, ColoringStrategy strategy, size_t blockSize, ThreadPool& pool) {
+	if (blockSize == 0) blockSize = 1;
+
+	ElementColoring res{};
+	res._color.assign(mesh.sizeFiniteElements(), uncolored);
+	if (res._color.empty()) {
+		res._colorOffsets = { 0 };
+		res._blockOffsets = { 0 };
+		res._colorBlocks = { 0 };
+		return res;
+	}
+
+	// the incidence is built once before the parallel rounds read it
+	mesh.elementsOfNode(0);
+
+	if (strategy == ColoringStrategy::JonesPlassmann) colorJonesPlassmann(mesh, res._color, pool);
+	else colorGreedy(mesh, res._color);
+
+	size_t colors = *std::ranges::max_element(res._color) + 1;
+	res._colorOffsets.assign(colors + 1, 0);
+	for (const size_t& c : res._color) res._colorOffsets[c + 1]++;
+	std::partial_sum(begin(res._colorOffsets), end(res._colorOffsets), begin(res._colorOffsets));
+
+	// elements of a color ordered by their first node, so a block touches nearby nodes
+	const std::vector<FiniteElement>& elements = mesh.getFiniteElements();
+	std::vector<size_t> firstNode(elements.size());
+	for (size_t i = 0; i < elements.size(); ++i) {
+		const std::vector<size_t>& ids = elements[i]._nodeIDvec;
+		firstNode[i] = ids.empty() ? 0 : *std::ranges::min_element(ids);
+	}
+
+	res._elements.resize(elements.size());
+	std::vector<size_t> fill(begin(res._colorOffsets), end(res._colorOffsets) - 1);
+	for (size_t i = 0; i < elements.size(); ++i) res._elements[fill[res._color[i]]++] = i;
+
+	res._colorBlocks.push_back(0);
+	for (size_t c = 0; c < colors; ++c) {
+		auto first = begin(res._elements) + res._colorOffsets[c];
+		auto last = begin(res._elements) + res._colorOffsets[c + 1];
+		std::sort(first, last, [&firstNode](size_t a, size_t b) { return std::pair(firstNode[a], a) < std::pair(firstNode[b], b); });
+
+		for (size_t at = res._colorOffsets[c]; at < res._colorOffsets[c + 1]; at += blockSize) res._blockOffsets.push_back(at);
+		res._colorBlocks.push_back(res._blockOffsets.size());
+	}
+	res._blockOffsets.push_back(res._elements.size());
+	return res;
+}
+
+// call body(element position) for every finite element, colors one after another, blocks in parallel
+void forEachElementColored(const ElementColoring& coloring, const std::function<void(size_t)>& body, ThreadPool& pool) {
+	for (size_t c = 0; c < coloring.colors(); ++c) {
+		size_t firstBlock = coloring._colorBlocks[c];
+		size_t blocks = coloring._colorBlocks[c + 1] - firstBlock;
+
+		pool.parallelFor(blocks, std::min(blocks, pool.size() * 4), [&](size_t, size_t begin, size_t end) {
+			for (size_t b = firstBlock + begin; b < firstBlock + end; ++b)
+				for (size_t i = coloring._blockOffsets[b]; i < coloring._blockOffsets[b + 1]; ++i) body(coloring._elements[i]);
+		});
+	}
+}
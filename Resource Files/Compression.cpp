@@ -0,0 +1,179 @@
+#include "Compression.h"
+#include "Exception.h"
+
+#include <vector>
+
+#ifdef MESH_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef MESH_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// plain stream without compression
+class StreamSource final : public ByteSource {
+public:
+	explicit StreamSource(std::istream& input) : _input(input) {}
+
+	size_t read(char* dest, size_t size) override {
+		_input.read(dest, static_cast<std::streamsize>(size));
+		if (_input.bad())
+			throw Exception("Read error while loading mesh data");
+		return static_cast<size_t>(_input.gcount());
+	}
+
+private:
+	std::istream& _input;
+};
+
+#if defined(MESH_WITH_ZLIB) || defined(MESH_WITH_ZSTD)
+// size of the compressed input chunk read from the file at once
+constexpr size_t compressedChunk = 1 << 18;
+
+// read the next compressed chunk, returns amount of bytes
+size_t readChunk(std::istream& input, std::vector<char>& chunk) {
+	input.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+	if (input.bad())
+		throw Exception("Read error while loading mesh data");
+	return static_cast<size_t>(input.gcount());
+}
+#endif
+
+#ifdef MESH_WITH_ZLIB
+// gzip stream (concatenated members are read one after another)
+class GzipSource final : public ByteSource {
+public:
+	explicit GzipSource(std::istream& input) : _input(input), _chunk(compressedChunk) {
+		// 16 + MAX_WBITS: expect a gzip header
+		if (inflateInit2(&_stream, 16 + MAX_WBITS) != Z_OK)
+			throw Exception("Unable to initialize gzip decompression");
+	}
+
+	~GzipSource() override { inflateEnd(&_stream); }
+
+	size_t read(char* dest, size_t size) override {
+		_stream.next_out = reinterpret_cast<Bytef*>(dest);
+		_stream.avail_out = static_cast<uInt>(size);
+
+		while (_stream.avail_out > 0 && !_done) {
+			if (_stream.avail_in == 0) {
+				size_t got = readChunk(_input, _chunk);
+				if (got == 0) {
+					if (!_memberEnd)
+						throw Exception("Unexpected end of gzip data");
+					_done = true;
+					break;
+				}
+				_stream.next_in = reinterpret_cast<Bytef*>(_chunk.data());
+				_stream.avail_in = static_cast<uInt>(got);
+			}
+
+			if (_memberEnd) {
+				inflateReset(&_stream);
+				_memberEnd = false;
+			}
+
+			int code = inflate(&_stream, Z_NO_FLUSH);
+			if (code == Z_STREAM_END) _memberEnd = true;
+			else if (code != Z_OK && code != Z_BUF_ERROR)
+				throw Exception("Corrupted gzip data: " + std::string(_stream.msg ? _stream.msg : "unknown error"));
+		}
+
+		return size - _stream.avail_out;
+	}
+
+private:
+	std::istream& _input;
+	std::vector<char> _chunk;
+	z_stream _stream{};
+	bool _memberEnd{};
+	bool _done{};
+};
+#endif
+
+#ifdef MESH_WITH_ZSTD
+// zstd stream (all frames of the file)
+class ZstdSource final : public ByteSource {
+public:
+	explicit ZstdSource(std::istream& input) : _input(input), _chunk(compressedChunk) {
+		_stream = ZSTD_createDStream();
+		if (!_stream)
+			throw Exception("Unable to initialize zstd decompression");
+	}
+
+	~ZstdSource() override { ZSTD_freeDStream(_stream); }
+
+	size_t read(char* dest, size_t size) override {
+		ZSTD_outBuffer out{ dest, size, 0 };
+
+		while (out.pos < out.size && !_done) {
+			if (_in.pos == _in.size) {
+				size_t got = readChunk(_input, _chunk);
+				if (got == 0) {
+					if (_hint != 0)
+						throw Exception("Unexpected end of zstd data");
+					_done = true;
+					break;
+				}
+				_in = { _chunk.data(), got, 0 };
+			}
+
+			_hint = ZSTD_decompressStream(_stream, &out, &_in);
+			if (ZSTD_isError(_hint))
+				throw Exception("Corrupted zstd data: " + std::string(ZSTD_getErrorName(_hint)));
+		}
+
+		return out.pos;
+	}
+
+private:
+	std::istream& _input;
+	std::vector<char> _chunk;
+	ZSTD_DStream* _stream{};
+	ZSTD_inBuffer _in{};
+	size_t _hint{};
+	bool _done{};
+};
+#endif
+
+} // namespace
+
+// detect compression by the magic bytes (stream position is restored)
+Compression detectCompression(std::istream& input) {
+	unsigned char magic[4]{};
+	std::streampos pos = input.tellg();
+
+	input.read(reinterpret_cast<char*>(magic), sizeof(magic));
+	size_t got = static_cast<size_t>(input.gcount());
+	input.clear();
+	input.seekg(pos);
+
+	if (got >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+		return Compression::Gzip;
+	if (got == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+		return Compression::Zstd;
+	return Compression::None;
+}
+
+// create a source that decompresses the stream on the fly
+std::unique_ptr<ByteSource> makeByteSource(std::istream& input, Compression compression) {
+	switch (compression) {
+	case Compression::Gzip:
+#ifdef MESH_WITH_ZLIB
+		return std::make_unique<GzipSource>(input);
+#else
+		throw Exception("Gzip input is not supported in this build (define MESH_WITH_ZLIB)");
+#endif
+	case Compression::Zstd:
+#ifdef MESH_WITH_ZSTD
+		return std::make_unique<ZstdSource>(input);
+#else
+		throw Exception("Zstd input is not supported in this build (define MESH_WITH_ZSTD)");
+#endif
+	default:
+		return std::make_unique<StreamSource>(input);
+	}
+}
@@ -52,21 +52,25 @@ size_t Hash::operator() (const BoundaryElement& BE) const {
 
 // function for string splicing
 std::vector<std::string> splice(const std::string& str) {
-	std::vector<std::string> res;
-	std::string temp;
+	auto separator = [](char c) { return c == ' ' || c == '\r' || c == '\\'; };
+
+	// tokens are counted first, so the result is allocated once
+	size_t tokens = 0;
+	for (size_t i = 0; i < str.size(); ++i)
+		if (!separator(str[i]) && (i == 0 || separator(str[i - 1]))) tokens++;
 
-	for (size_t i = 0; i < str.size(); ++i) {
-		if (str[i] != ' ' && 
-		    str[i] != '\r' && 
-		    str[i] != '\\') 
-			temp.push_back(str[i]);
+	std::vector<std::string> res;
+	res.reserve(tokens);
 
-		else if (temp.size() > 0) {
-			res.push_back(temp);
-			temp.clear();
+	for (size_t i = 0; i < str.size();) {
+		if (separator(str[i])) {
+			i++;
+			continue;
 		}
+		size_t start = i;
+		while (i < str.size() && !separator(str[i])) i++;
+		res.emplace_back(str, start, i - start);
 	}
-	if (temp.size() > 0) res.push_back(temp);
 	return res;
 }
 
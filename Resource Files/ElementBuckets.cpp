@@ -0,0 +1,243 @@
+#include <map>
+
+#include "ElementBuckets.h"
+
+namespace {
+
+using Vec3 = std::array<double, 3>;
+
+Vec3 sub(const Vec3& a, const Vec3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+
+Vec3 cross(const Vec3& a, const Vec3& b) {
+	return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+
+double norm(const Vec3& a) { return std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]); }
+
+// six times the signed volume of the tetrahedron a, b, c, d
+double tetrahedron6(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d) {
+	Vec3 u = sub(b, a), v = sub(c, a), w = sub(d, a);
+	Vec3 n = cross(v, w);
+	return u[0] * n[0] + u[1] * n[1] + u[2] * n[2];
+}
+
+// sum of the signed volumes of tetrahedra given by local vertex positions
+template <size_t N>
+double splitVolume(std::span<const Vec3> p, const uint8_t (&tetrahedra)[N][4]) {
+	double res = 0;
+	for (const auto& t : tetrahedra) res += tetrahedron6(p[t[0]], p[t[1]], p[t[2]], p[t[3]]);
+	return res / 6;
+}
+
+// the pyramid is split along the base diagonal 0-2, the prism and the hexahedron
+// around the diagonals from vertex 0, every piece keeps the orientation of the whole shape
+constexpr uint8_t pyramidSplit[2][4] = { { 0, 1, 2, 4 }, { 0, 2, 3, 4 } };
+constexpr uint8_t prismSplit[3][4] = { { 0, 1, 2, 5 }, { 0, 1, 5, 4 }, { 0, 4, 5, 3 } };
+constexpr uint8_t hexahedronSplit[6][4] = { { 0, 1, 2, 6 }, { 0, 2, 3, 6 }, { 0, 3, 7, 6 },
+					    { 0, 7, 4, 6 }, { 0, 4, 5, 6 }, { 0, 5, 1, 6 } };
+
+constexpr std::array<uint8_t, 2> segmentEdges[] = { { 0, 1 } };
+constexpr std::array<uint8_t, 2> triangleEdges[] = { { 0, 1 }, { 1, 2 }, { 2, 0 } };
+constexpr std::array<uint8_t, 2> quadrilateralEdges[] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+constexpr std::array<uint8_t, 2> tetrahedronEdges[] = { { 0, 1 }, { 1, 2 }, { 2, 0 }, { 0, 3 }, { 1, 3 }, { 2, 3 } };
+constexpr std::array<uint8_t, 2> pyramidEdges[] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+						    { 0, 4 }, { 1, 4 }, { 2, 4 }, { 3, 4 } };
+constexpr std::array<uint8_t, 2> prismEdges[] = { { 0, 1 }, { 1, 2 }, { 2, 0 }, { 3, 4 }, { 4, 5 }, { 5, 3 },
+						  { 0, 3 }, { 1, 4 }, { 2, 5 } };
+constexpr std::array<uint8_t, 2> hexahedronEdges[] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 },
+						       { 6, 7 }, { 7, 4 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+size_t areaId(const FiniteElement& el) { return el._material_area_id; }
+
+size_t areaId(const BoundaryElement& el) { return el._surface_area_id; }
+
+// shared part of both bucketElements
+template <class Element>
+ElementBuckets bucketBlock(const std::vector<Element>& elements, size_t dim) {
+	ElementBuckets res{};
+	size_t n = elements.size();
+	res._ids.resize(n);
+	res._bucketOf.resize(n);
+	res._indexOf.resize(n);
+
+	// amount of elements of every key, buckets are numbered in the order of their keys
+	std::map<std::pair<ElementType, size_t>, size_t> keys;
+	for (size_t i = 0; i < n; ++i) {
+		size_t arity = elements[i]._nodeIDvec.size();
+		keys[{ elementType(dim, arity), arity }]++;
+	}
+	for (auto& [key, bucket] : keys) {
+		ElementBucket& added = res._buckets.emplace_back();
+		added._type = key.first;
+		added._arity = key.second;
+		added._positions.reserve(bucket);
+		added._ids.reserve(bucket);
+		added._areaIds.reserve(bucket);
+		added._nodes.reserve(bucket * key.second);
+		bucket = res._buckets.size() - 1;
+	}
+
+	// elements of a block usually share one key, so the last one is tried first
+	auto last = begin(keys);
+	for (size_t i = 0; i < n; ++i) {
+		const Element& el = elements[i];
+		size_t arity = el._nodeIDvec.size();
+		if (last->first.second != arity) last = keys.find({ elementType(dim, arity), arity });
+
+		ElementBucket& bucket = res._buckets[last->second];
+		res._ids[i] = el._id;
+		res._bucketOf[i] = static_cast<uint32_t>(last->second);
+		res._indexOf[i] = bucket.size();
+		bucket._positions.push_back(i);
+		bucket._ids.push_back(el._id);
+		bucket._areaIds.push_back(areaId(el));
+		bucket._nodes.insert(end(bucket._nodes), begin(el._nodeIDvec), end(el._nodeIDvec));
+	}
+	return res;
+}
+
+} // namespace
+
+// shape of an element with an amount of nodes in a space of a given dimension
+ElementType elementType(size_t dim, size_t nodes) {
+	if (dim == 1) {
+		switch (nodes) {
+		case 2: case 3: return ElementType::Segment;
+		default: return ElementType::Unknown;
+		}
+	}
+	if (dim == 2) {
+		switch (nodes) {
+		case 3: case 6: return ElementType::Triangle;
+		case 4: case 8: case 9: return ElementType::Quadrilateral;
+		default: return ElementType::Unknown;
+		}
+	}
+	if (dim == 3) {
+		switch (nodes) {
+		case 4: case 10: return ElementType::Tetrahedron;
+		case 5: case 13: case 14: return ElementType::Pyramid;
+		case 6: case 15: case 18: return ElementType::Prism;
+		case 8: case 20: case 27: return ElementType::Hexahedron;
+		default: return ElementType::Unknown;
+		}
+	}
+	return ElementType::Unknown;
+}
+
+// name of a shape for printing
+const char* elementTypeName(ElementType type) {
+	switch (type) {
+	case ElementType::Segment: return "segment";
+	case ElementType::Triangle: return "triangle";
+	case ElementType::Quadrilateral: return "quadrilateral";
+	case ElementType::Tetrahedron: return "tetrahedron";
+	case ElementType::Pyramid: return "pyramid";
+	case ElementType::Prism: return "prism";
+	case ElementType::Hexahedron: return "hexahedron";
+	default: return "unknown";
+	}
+}
+
+// dimension of a shape
+size_t elementDimension(ElementType type) {
+	switch (type) {
+	case ElementType::Segment: return 1;
+	case ElementType::Triangle: case ElementType::Quadrilateral: return 2;
+	case ElementType::Unknown: return 0;
+	default: return 3;
+	}
+}
+
+// amount of corner vertices of a shape
+size_t vertexCount(ElementType type) {
+	switch (type) {
+	case ElementType::Segment: return 2;
+	case ElementType::Triangle: return 3;
+	case ElementType::Quadrilateral: case ElementType::Tetrahedron: return 4;
+	case ElementType::Pyramid: return 5;
+	case ElementType::Prism: return 6;
+	case ElementType::Hexahedron: return 8;
+	default: return 0;
+	}
+}
+
+// edges of a shape as pairs of local vertex positions
+std::span<const std::array<uint8_t, 2>> localEdges(ElementType type) {
+	switch (type) {
+	case ElementType::Segment: return segmentEdges;
+	case ElementType::Triangle: return triangleEdges;
+	case ElementType::Quadrilateral: return quadrilateralEdges;
+	case ElementType::Tetrahedron: return tetrahedronEdges;
+	case ElementType::Pyramid: return pyramidEdges;
+	case ElementType::Prism: return prismEdges;
+	case ElementType::Hexahedron: return hexahedronEdges;
+	default: return {};
+	}
+}
+
+// length / area / volume of a shape from its corner coordinates
+double signedMeasure(ElementType type, std::span<const std::array<double, 3>> p, size_t dim) {
+	if (p.size() < vertexCount(type)) return 0;
+
+	switch (type) {
+	case ElementType::Segment:
+		return dim == 1 ? p[1][0] - p[0][0] : norm(sub(p[1], p[0]));
+	case ElementType::Triangle: {
+		Vec3 n = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+		return dim == 2 ? n[2] / 2 : norm(n) / 2;
+	}
+	case ElementType::Quadrilateral: {
+		// half the cross product of the diagonals (the vector area of a warped one)
+		Vec3 n = cross(sub(p[2], p[0]), sub(p[3], p[1]));
+		return dim == 2 ? n[2] / 2 : norm(n) / 2;
+	}
+	case ElementType::Tetrahedron: return tetrahedron6(p[0], p[1], p[2], p[3]) / 6;
+	case ElementType::Pyramid: return splitVolume(p, pyramidSplit);
+	case ElementType::Prism: return splitVolume(p, prismSplit);
+	case ElementType::Hexahedron: return splitVolume(p, hexahedronSplit);
+	default: return 0;
+	}
+}
+
+// measure of the reference element of a shape
+double referenceMeasure(ElementType type) {
+	switch (type) {
+	case ElementType::Segment: case ElementType::Quadrilateral: case ElementType::Hexahedron: return 1;
+	case ElementType::Triangle: case ElementType::Prism: return 0.5;
+	case ElementType::Tetrahedron: return 1.0 / 6;
+	case ElementType::Pyramid: return 1.0 / 3;
+	default: return 0;
+	}
+}
+
+// bucket and index of an element id
+ElementBuckets::Location ElementBuckets::locate(size_t id) const {
+	// ids are usually 1..n without gaps
+	size_t position = npos;
+	if (id >= 1 && id <= _ids.size() && _ids[id - 1] == id) position = id - 1;
+	else {
+		auto it = std::ranges::lower_bound(_ids, id);
+		if (it != end(_ids) && *it == id) position = static_cast<size_t>(it - begin(_ids));
+	}
+
+	if (position == npos) return { npos, npos };
+	return { _bucketOf[position], _indexOf[position] };
+}
+
+// bucket with a shape and an amount of nodes
+const ElementBucket* ElementBuckets::find(ElementType type, size_t arity) const {
+	for (const ElementBucket& bucket : _buckets)
+		if (bucket._type == type && bucket._arity == arity) return &bucket;
+	return nullptr;
+}
+
+// split the finite elements into buckets
+ElementBuckets bucketElements(const std::vector<FiniteElement>& elements, size_t dim) {
+	return bucketBlock(elements, dim);
+}
+
+// split the boundary elements into buckets, they are one dimension lower than the space
+ElementBuckets bucketElements(const std::vector<BoundaryElement>& elements, size_t dim) {
+	return bucketBlock(elements, dim ? dim - 1 : 0);
+}
@@ -0,0 +1,23 @@
+#include "Expected.h"
+
+// name of an error code
+const char* errorName(ErrorCode code) {
+	switch (code) {
+	case ErrorCode::OpenFailed: return "open failed";
+	case ErrorCode::UnexpectedEnd: return "unexpected end of file";
+	case ErrorCode::BadHeader: return "bad header";
+	case ErrorCode::BadNumber: return "bad number";
+	case ErrorCode::BadRecord: return "bad record";
+	case ErrorCode::MissingNode: return "missing node";
+	case ErrorCode::NotVertex: return "not a vertex";
+	case ErrorCode::Io: return "i/o error";
+	case ErrorCode::Cancelled: return "cancelled";
+	}
+	return "unknown error";
+}
+
+// one line description with the position
+std::string MeshError::describe() const {
+	if (_line == 0) return _message;
+	return _message + " (line " + std::to_string(_line) + ", offset " + std::to_string(_offset) + ")";
+}
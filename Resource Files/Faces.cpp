@@ -0,0 +1,188 @@
+#include "Faces.h"
+
+#include <cstdint>
+
+namespace {
+
+// sorted vertex ids of a face, unused positions are 0
+using FaceKey = std::array<size_t, 4>;
+
+// one face of a finite element or one boundary element
+struct FaceRecord {
+	FaceKey _key{};
+	size_t _id{};        // finite or boundary element id
+	uint32_t _local{};   // local face index (finite elements only)
+	bool _boundary{};    // record of a boundary element
+};
+
+size_t hashKey(const FaceKey& key) {
+	// splitmix64 finalizer over the vertex ids
+	uint64_t h = 0x9e3779b97f4a7c15ull;
+	for (const size_t& id : key) {
+		h ^= id + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+		h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+		h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+		h ^= h >> 31;
+	}
+	return static_cast<size_t>(h);
+}
+
+FaceKey makeKey(const std::vector<size_t>& ids, const std::vector<size_t>& positions) {
+	FaceKey key{};
+	for (size_t i = 0; i < positions.size(); ++i) key[i] = ids[positions[i]];
+	std::sort(begin(key), begin(key) + positions.size());
+	return key;
+}
+
+} // namespace
+
+// faces of an element type as local vertex positions, empty for unknown types
+const std::vector<std::vector<size_t>>& localFaces(size_t dim, size_t nodes) {
+	static const std::vector<std::vector<size_t>> none{};
+	static const std::vector<std::vector<size_t>> triangle{ { 0, 1 }, { 1, 2 }, { 2, 0 } };
+	static const std::vector<std::vector<size_t>> quadrilateral{ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+	static const std::vector<std::vector<size_t>> tetrahedron{ { 1, 2, 3 }, { 0, 3, 2 }, { 0, 1, 3 }, { 0, 2, 1 } };
+	static const std::vector<std::vector<size_t>> pyramid{ { 0, 3, 2, 1 }, { 0, 1, 4 }, { 1, 2, 4 }, { 2, 3, 4 }, { 3, 0, 4 } };
+	static const std::vector<std::vector<size_t>> prism{ { 0, 2, 1 }, { 3, 4, 5 }, { 0, 1, 4, 3 }, { 1, 2, 5, 4 }, { 2, 0, 3, 5 } };
+	static const std::vector<std::vector<size_t>> hexahedron{ { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 }, 
+								  { 1, 2, 6, 5 }, { 2, 3, 7, 6 }, { 3, 0, 4, 7 } };
+
+	if (dim == 2) {
+		switch (nodes) {
+		case 3: case 6: return triangle;
+		case 4: case 8: return quadrilateral;
+		default: return none;
+		}
+	}
+	if (dim == 3) {
+		switch (nodes) {
+		case 4: case 10: return tetrahedron;
+		case 5: case 13: return pyramid;
+		case 6: case 15: return prism;
+		case 8: case 20: return hexahedron;
+		default: return none;
+		}
+	}
+	return none;
+}
+
+// amount of vertices of a face or boundary element with a given amount of nodes (0 if unknown)
+size_t faceVertices(size_t dim, size_t nodes) {
+	if (dim == 2 && (nodes == 2 || nodes == 3)) return 2;
+	if (dim == 3 && (nodes == 3 || nodes == 6)) return 3;
+	if (dim == 3 && (nodes == 4 || nodes == 8 || nodes == 9)) return 4;
+	return 0;
+}
+
+// enumerate the faces of all finite elements and match them in one parallel pass
+FaceTopology buildFaceTopology(const FrozenMesh& mesh, ThreadPool& pool) {
+	const std::vector<FiniteElement>& elements = mesh.getFiniteElements();
+	const std::vector<BoundaryElement>& boundary = mesh.getBoundaryElements();
+	size_t dim = mesh.spaceDim();
+
+	// records[chunk][bucket], buckets are picked by the key hash
+	size_t chunks = pool.size() * 4;
+	size_t buckets = pool.size() * 4;
+	std::vector<std::vector<std::vector<FaceRecord>>> records(chunks, std::vector<std::vector<FaceRecord>>(buckets));
+	size_t total = elements.size() + boundary.size();
+
+	pool.parallelFor(total, chunks, [&](size_t chunk, size_t first, size_t last) {
+		std::vector<std::vector<FaceRecord>>& out = records[chunk];
+
+		for (size_t i = first; i < last; ++i) {
+			if (i < elements.size()) {
+				const FiniteElement& el = elements[i];
+				const std::vector<std::vector<size_t>>& faces = localFaces(dim, el._nodeIDvec.size());
+				for (size_t f = 0; f < faces.size(); ++f) {
+					FaceRecord record{ makeKey(el._nodeIDvec, faces[f]), el._id, static_cast<uint32_t>(f), false };
+					out[hashKey(record._key) % buckets].push_back(record);
+				}
+				continue;
+			}
+
+			const BoundaryElement& el = boundary[i - elements.size()];
+			size_t vertices = faceVertices(dim, el._nodeIDvec.size());
+			std::vector<size_t> positions(vertices);
+			std::iota(begin(positions), end(positions), 0);
+
+			FaceRecord record{ vertices ? makeKey(el._nodeIDvec, positions) : FaceKey{}, el._id, 0, true };
+			out[hashKey(record._key) % buckets].push_back(record);
+		}
+	});
+
+	// every bucket is matched independently
+	std::vector<FaceTopology> partial(buckets);
+
+	pool.parallelFor(buckets, buckets, [&](size_t, size_t first, size_t last) {
+		std::vector<FaceRecord> bucket;
+
+		for (size_t b = first; b < last; ++b) {
+			bucket.clear();
+			for (size_t c = 0; c < chunks; ++c)
+				bucket.insert(end(bucket), begin(records[c][b]), end(records[c][b]));
+
+			// finite element records first within a face, both by id
+			std::ranges::sort(bucket, [](const FaceRecord& lhs, const FaceRecord& rhs) {
+				return std::tie(lhs._key, lhs._boundary, lhs._id) < std::tie(rhs._key, rhs._boundary, rhs._id);
+			});
+
+			FaceTopology& topology = partial[b];
+			for (size_t i = 0; i < bucket.size();) {
+				size_t j = i;
+				while (j < bucket.size() && bucket[j]._key == bucket[i]._key) j++;
+
+				size_t owners = 0;
+				while (i + owners < j && !bucket[i + owners]._boundary) owners++;
+				size_t boundaryCount = j - i - owners;
+
+				if (owners == 1 && boundaryCount == 0)
+					topology._uncoveredFaces.push_back({ bucket[i]._id, bucket[i]._local });
+				if (owners == 1)
+					topology._exteriorFaces.push_back({ bucket[i]._id, bucket[i]._local });
+				if (owners == 2) {
+					topology._interiorFaces++;
+					topology._interiorFacePairs.emplace_back(bucket[i]._id, bucket[i + 1]._id);
+				}
+				if (owners > 2)
+					for (size_t k = i; k < i + owners; ++k)
+						topology._nonManifoldFaces.push_back({ bucket[k]._id, bucket[k]._local });
+
+				for (size_t k = i + owners; k < j; ++k) {
+					if (owners == 0 || bucket[k]._key == FaceKey{}) {
+						topology._unmatchedBoundaryElements.push_back(bucket[k]._id);
+						continue;
+					}
+					topology._boundaryOwners[bucket[k]._id] = { bucket[i]._id, bucket[i]._local };
+					if (owners > 1) topology._interiorBoundaryElements.push_back(bucket[k]._id);
+				}
+				i = j;
+			}
+		}
+	});
+
+	// merge the buckets, lists are sorted by element id
+	FaceTopology res{};
+	for (FaceTopology& topology : partial) {
+		res._exteriorFaces.insert(end(res._exteriorFaces), begin(topology._exteriorFaces), end(topology._exteriorFaces));
+		res._interiorFaces += topology._interiorFaces;
+		res._interiorFacePairs.insert(end(res._interiorFacePairs), begin(topology._interiorFacePairs), end(topology._interiorFacePairs));
+		res._nonManifoldFaces.insert(end(res._nonManifoldFaces), begin(topology._nonManifoldFaces), end(topology._nonManifoldFaces));
+		res._boundaryOwners.merge(topology._boundaryOwners);
+		res._interiorBoundaryElements.insert(end(res._interiorBoundaryElements), 
+						     begin(topology._interiorBoundaryElements), end(topology._interiorBoundaryElements));
+		res._unmatchedBoundaryElements.insert(end(res._unmatchedBoundaryElements), 
+						      begin(topology._unmatchedBoundaryElements), end(topology._unmatchedBoundaryElements));
+		res._uncoveredFaces.insert(end(res._uncoveredFaces), begin(topology._uncoveredFaces), end(topology._uncoveredFaces));
+	}
+
+	auto byElement = [](const FaceRef& lhs, const FaceRef& rhs) {
+		return std::tie(lhs._element, lhs._localFace) < std::tie(rhs._element, rhs._localFace);
+	};
+	std::ranges::sort(res._exteriorFaces, byElement);
+	std::ranges::sort(res._interiorFacePairs);
+	std::ranges::sort(res._nonManifoldFaces, byElement);
+	std::ranges::sort(res._uncoveredFaces, byElement);
+	std::ranges::sort(res._interiorBoundaryElements);
+	std::ranges::sort(res._unmatchedBoundaryElements);
+	return res;
+}
@@ -0,0 +1,238 @@
+#include "FrozenMesh.h"
+#include "Writer.h"
+
+// constructor (copies the mesh, the loader may be changed or destroyed afterwards)
+FrozenMesh::FrozenMesh(const AneuMeshLoader& mesh) : 
+	_spaceDimension(mesh.spaceDim()),
+	_amountOfNodesInOneFiniteElement(mesh.nodesInFE()),
+	_amountOfNodesInOneBoundaryElement(mesh.nodesInBE()),
+	_nodes(mesh.getNodes()),
+	_finiteElements(mesh.getFiniteElements()),
+	_boundaryElements(mesh.getBoundaryElements()) {}
+
+// constructor from an image in the binary cache format (copies the data)
+FrozenMesh::FrozenMesh(const BinaryMeshView& view) :
+	_spaceDimension(view._spaceDimension),
+	_amountOfNodesInOneFiniteElement(view._nodesInFE),
+	_amountOfNodesInOneBoundaryElement(view._nodesInBE) {
+	size_t nodes = view._nodeIds.size();
+	_nodes.resize(nodes, Node(_spaceDimension));
+	for (size_t i = 0; i < nodes; ++i) {
+		_nodes[i]._id = view._nodeIds[i];
+		_nodes[i]._is_vertex = view._isVertex[i] != 0;
+		for (size_t axis = 0; axis < _spaceDimension; ++axis) _nodes[i]._coords[axis] = view._coords[axis * nodes + i];
+	}
+
+	_finiteElements.resize(view._finiteElementIds.size());
+	for (size_t i = 0; i < _finiteElements.size(); ++i) {
+		_finiteElements[i]._id = view._finiteElementIds[i];
+		_finiteElements[i]._material_area_id = view._materialIds[i];
+		auto ids = view._finiteElementNodes.subspan(i * view._nodesInFE, view._nodesInFE);
+		_finiteElements[i]._nodeIDvec.assign(begin(ids), end(ids));
+	}
+
+	_boundaryElements.resize(view._boundaryElementIds.size());
+	for (size_t i = 0; i < _boundaryElements.size(); ++i) {
+		_boundaryElements[i]._id = view._boundaryElementIds[i];
+		_boundaryElements[i]._surface_area_id = view._surfaceIds[i];
+		auto ids = view._boundaryElementNodes.subspan(i * view._nodesInBE, view._nodesInBE);
+		_boundaryElements[i]._nodeIDvec.assign(begin(ids), end(ids));
+	}
+}
+
+// position of a Node in getNodes() (npos if it is not present)
+size_t FrozenMesh::nodeIndex(size_t id) const {
+	return NodeIncidence::position(_nodes, id, &Node::_id);
+}
+
+// getter for one Node by id (nullptr if it is not present)
+const Node* FrozenMesh::findNode(size_t id) const {
+	size_t index = nodeIndex(id);
+	return index == npos ? nullptr : &_nodes[index];
+}
+
+// Finite Elements split by shape and amount of nodes (built on first use)
+const ElementBuckets& FrozenMesh::finiteBuckets() const {
+	std::call_once(_finiteBucketsFlag, [this] { _finiteBuckets = bucketElements(_finiteElements, _spaceDimension); });
+	return _finiteBuckets;
+}
+
+// Boundary Elements split by shape and amount of nodes (built on first use)
+const ElementBuckets& FrozenMesh::boundaryBuckets() const {
+	std::call_once(_boundaryBucketsFlag, [this] { _boundaryBuckets = bucketElements(_boundaryElements, _spaceDimension); });
+	return _boundaryBuckets;
+}
+
+// node -> finite elements incidence in CSR form (built on first use)
+void FrozenMesh::buildIncidence() const {
+	std::call_once(_incidenceFlag, [this] {
+		_incidence = NodeIncidence(_nodes.size(), 
+					   _finiteElements.size(), 
+					   [this](size_t id) { return nodeIndex(id); }, 
+					   [this](size_t e) -> const std::vector<size_t>& { return _finiteElements[e]._nodeIDvec; });
+	});
+}
+
+// area id -> boundary elements positions (built on first use)
+void FrozenMesh::buildAreaIndex() const {
+	std::call_once(_areaFlag, [this] {
+		for (size_t i = 0; i < _boundaryElements.size(); ++i)
+			_areaIndex[_boundaryElements[i]._surface_area_id].push_back(i);
+	});
+}
+
+// positions in getFiniteElements() of the elements using a node position (sorted)
+std::span<const size_t> FrozenMesh::elementsOfNode(size_t index) const {
+	buildIncidence();
+	return _incidence.elementsOf(index);
+}
+
+// finite elements containing all given node ids, checked for presence and, if asked, for being vertices
+Expected<std::vector<FiniteElement>> FrozenMesh::findByNodes(std::initializer_list<size_t> ids, bool vertices) const {
+	std::vector<size_t> nodes;
+	for (const size_t& id : ids) nodes.push_back(nodeIndex(id));
+
+	Expected<void> checked = checkQueryNodes(nodes, vertices, [this](size_t index) { return _nodes[index]._is_vertex; });
+	if (!checked) return checked.error();
+
+	buildIncidence();
+	std::vector<FiniteElement> res{};
+	for (const size_t& i : _incidence.intersect(nodes)) res.push_back(_finiteElements[i]);
+	return res;
+}
+
+// method for finding Finite Elements by 3 vertex Node ids
+std::vector<FiniteElement> FrozenMesh::findFiniteElementsByVertices(size_t node1id, 
+								    size_t node2id, 
+								    size_t node3id) const {
+	return tryFindFiniteElementsByVertices(node1id, node2id, node3id).value();
+}
+
+// method for finding Finite Elements by 2 Node ids
+std::vector<FiniteElement> FrozenMesh::findFiniteElementsByEdges(size_t node1id, 
+								 size_t node2id) const {
+	return tryFindFiniteElementsByEdges(node1id, node2id).value();
+}
+
+// findFiniteElementsByVertices without exceptions
+Expected<std::vector<FiniteElement>> FrozenMesh::tryFindFiniteElementsByVertices(size_t node1id, 
+										  size_t node2id, 
+										  size_t node3id) const {
+	return findByNodes({ node1id, node2id, node3id }, true);
+}
+
+// findFiniteElementsByEdges without exceptions
+Expected<std::vector<FiniteElement>> FrozenMesh::tryFindFiniteElementsByEdges(size_t node1id, 
+									       size_t node2id) const {
+	return findByNodes({ node1id, node2id }, false);
+}
+
+// shared part of the batched queries
+template <size_t N>
+void FrozenMesh::findBatch(std::span<const std::array<size_t, N>>	queries, 
+			   QueryBatchResult&				result, 
+			   ThreadPool&					pool) const {
+	buildIncidence();
+
+	// checked up front, so the parallel part can't throw
+	auto isVertex = [this](size_t index) { return _nodes[index]._is_vertex; };
+	for (size_t i = 0; i < queries.size(); ++i) {
+		std::array<size_t, N> nodes;
+		std::ranges::transform(queries[i], begin(nodes), [this](size_t id) { return nodeIndex(id); });
+		Expected<void> checked = checkQueryNodes(nodes, N == 3, isVertex);
+		if (!checked) throw Exception("Query " + std::to_string(i) + ": " + checked.error()._message);
+	}
+
+	// small batches are not worth waking the workers; parallelFor runs at most one chunk per query,
+	// so more chunks would leave the results of an earlier batch in the unused buffers
+	size_t chunks = queries.size() < 1024 ? 1 : std::min(pool.size() * 4, queries.size());
+	if (result._chunkElements.size() < chunks) result._chunkElements.resize(chunks);
+	result._counts.resize(queries.size());
+
+	auto body = [&](size_t chunk, size_t first, size_t last) {
+		std::vector<size_t>& out = result._chunkElements[chunk];
+		std::vector<size_t> scratch;
+		std::array<size_t, N> nodes;
+		out.clear();
+
+		for (size_t q = first; q < last; ++q) {
+			size_t before = out.size();
+			std::ranges::transform(queries[q], begin(nodes), [this](size_t id) { return nodeIndex(id); });
+			_incidence.intersect(nodes, out, scratch);
+			for (size_t i = before; i < out.size(); ++i) out[i] = _finiteElements[out[i]]._id;
+			result._counts[q] = out.size() - before;
+		}
+	};
+
+	if (chunks == 1) body(0, 0, queries.size());
+	else pool.parallelFor(queries.size(), chunks, body);
+
+	result._offsets.resize(queries.size() + 1);
+	result._offsets[0] = 0;
+	std::partial_sum(begin(result._counts), end(result._counts), begin(result._offsets) + 1);
+
+	result._elements.resize(result._offsets.back());
+	size_t position = 0;
+	for (size_t chunk = 0; chunk < chunks; ++chunk) {
+		std::ranges::copy(result._chunkElements[chunk], begin(result._elements) + position);
+		position += result._chunkElements[chunk].size();
+	}
+}
+
+// batched method for finding Finite Elements by pairs of Node ids (parallel)
+void FrozenMesh::findFiniteElementsByEdges(std::span<const std::array<size_t, 2>>	queries, 
+					   QueryBatchResult&				result, 
+					   ThreadPool&					pool) const {
+	findBatch<2>(queries, result, pool);
+}
+
+// batched method for finding Finite Elements by triples of vertex Node ids (parallel)
+void FrozenMesh::findFiniteElementsByVertices(std::span<const std::array<size_t, 3>>	queries, 
+					      QueryBatchResult&				result, 
+					      ThreadPool&				pool) const {
+	findBatch<3>(queries, result, pool);
+}
+
+// method for finding Boundary Elements by an area ID
+std::vector<BoundaryElement> FrozenMesh::findBoundaryElementsByAreaID(size_t areaid) const {
+	buildAreaIndex();
+	std::vector<BoundaryElement> res{};
+
+	auto it = _areaIndex.find(areaid);
+	if (it == end(_areaIndex)) return res;
+
+	for (const size_t& i : it->second) res.push_back(_boundaryElements[i]);
+	return res;
+}
+
+// method for finding Finite Elements by a material ID
+std::vector<FiniteElement> FrozenMesh::findFiniteElementsByMaterialID(size_t materialid) const {
+	std::vector<FiniteElement> res{};
+	std::ranges::copy_if(_finiteElements, std::back_inserter(res),
+		[materialid](const FiniteElement& el) {
+			return el._material_area_id == materialid;
+		});
+	return res;
+}
+
+// method for finding all unique Nodes of Boundary Elements with the same given area ID
+std::vector<Node> FrozenMesh::findBENodesByAreaID(size_t areaid) const {
+	buildAreaIndex();
+	std::vector<size_t> indices{};
+
+	auto it = _areaIndex.find(areaid);
+	if (it == end(_areaIndex)) return {};
+
+	for (const size_t& i : it->second)
+		for (const size_t& id : _boundaryElements[i]._nodeIDvec) {
+			size_t index = nodeIndex(id);
+			if (index != npos) indices.push_back(index);
+		}
+
+	std::ranges::sort(indices);
+	indices.erase(std::unique(begin(indices), end(indices)), end(indices));
+
+	std::vector<Node> res{};
+	for (const size_t& i : indices) res.push_back(_nodes[i]);
+	return res;
+}
@@ -0,0 +1,302 @@
+#include "Geometry.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MESH_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles intrinsics without per-function target flags
+#if defined(MESH_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MESH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define MESH_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define MESH_TARGET_AVX2
+#define MESH_TARGET_AVX512
+#endif
+
+namespace {
+
+// kernel over elements [first, last): coords[v * dim + d] is the SoA array of coordinate d of vertex v,
+// writes the jacobian and the SoA centroid arrays
+using Kernel = void (*)(const double* const*, size_t, size_t, double*, double* const*);
+
+// scalar kernel for triangles in 2D
+void triangleScalar(const double* const* c, size_t first, size_t last, double* jacobian, double* const* centroid) {
+	for (size_t i = first; i < last; ++i) {
+		double ax = c[2][i] - c[0][i], ay = c[3][i] - c[1][i];
+		double bx = c[4][i] - c[0][i], by = c[5][i] - c[1][i];
+		jacobian[i] = ax * by - ay * bx;
+		centroid[0][i] = (c[0][i] + c[2][i] + c[4][i]) / 3;
+		centroid[1][i] = (c[1][i] + c[3][i] + c[5][i]) / 3;
+	}
+}
+
+// scalar kernel for tetrahedra in 3D
+void tetrahedronScalar(const double* const* c, size_t first, size_t last, double* jacobian, double* const* centroid) {
+	for (size_t i = first; i < last; ++i) {
+		double ax = c[3][i] - c[0][i], ay = c[4][i] - c[1][i], az = c[5][i] - c[2][i];
+		double bx = c[6][i] - c[0][i], by = c[7][i] - c[1][i], bz = c[8][i] - c[2][i];
+		double cx = c[9][i] - c[0][i], cy = c[10][i] - c[1][i], cz = c[11][i] - c[2][i];
+		jacobian[i] = ax * (by * cz - bz * cy) - ay * (bx * cz - bz * cx) + az * (bx * cy - by * cx);
+		for (size_t d = 0; d < 3; ++d)
+			centroid[d][i] = (c[d][i] + c[3 + d][i] + c[6 + d][i] + c[9 + d][i]) * 0.25;
+	}
+}
+
+#ifdef MESH_SIMD_X86
+// AVX2 kernel for triangles in 2D, 4 elements per step
+MESH_TARGET_AVX2 
+void triangleAvx2(const double* const* c, size_t first, size_t last, double* jacobian, double* const* centroid) {
+	const __m256d third = _mm256_set1_pd(1.0 / 3);
+	size_t i = first;
+	for (; i + 4 <= last; i += 4) {
+		__m256d x0 = _mm256_loadu_pd(c[0] + i), y0 = _mm256_loadu_pd(c[1] + i);
+		__m256d x1 = _mm256_loadu_pd(c[2] + i), y1 = _mm256_loadu_pd(c[3] + i);
+		__m256d x2 = _mm256_loadu_pd(c[4] + i), y2 = _mm256_loadu_pd(c[5] + i);
+		__m256d ax = _mm256_sub_pd(x1, x0), ay = _mm256_sub_pd(y1, y0);
+		__m256d bx = _mm256_sub_pd(x2, x0), by = _mm256_sub_pd(y2, y0);
+		_mm256_storeu_pd(jacobian + i, _mm256_fmsub_pd(ax, by, _mm256_mul_pd(ay, bx)));
+		_mm256_storeu_pd(centroid[0] + i, _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(x0, x1), x2), third));
+		_mm256_storeu_pd(centroid[1] + i, _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(y0, y1), y2), third));
+	}
+	triangleScalar(c, i, last, jacobian, centroid);
+}
+
+// AVX2 kernel for tetrahedra in 3D, 4 elements per step
+MESH_TARGET_AVX2 
+void tetrahedronAvx2(const double* const* c, size_t first, size_t last, double* jacobian, double* const* centroid) {
+	const __m256d quarter = _mm256_set1_pd(0.25);
+	size_t i = first;
+	for (; i + 4 <= last; i += 4) {
+		__m256d x0 = _mm256_loadu_pd(c[0] + i), y0 = _mm256_loadu_pd(c[1] + i), z0 = _mm256_loadu_pd(c[2] + i);
+		__m256d x1 = _mm256_loadu_pd(c[3] + i), y1 = _mm256_loadu_pd(c[4] + i), z1 = _mm256_loadu_pd(c[5] + i);
+		__m256d x2 = _mm256_loadu_pd(c[6] + i), y2 = _mm256_loadu_pd(c[7] + i), z2 = _mm256_loadu_pd(c[8] + i);
+		__m256d x3 = _mm256_loadu_pd(c[9] + i), y3 = _mm256_loadu_pd(c[10] + i), z3 = _mm256_loadu_pd(c[11] + i);
+
+		__m256d ax = _mm256_sub_pd(x1, x0), ay = _mm256_sub_pd(y1, y0), az = _mm256_sub_pd(z1, z0);
+		__m256d bx = _mm256_sub_pd(x2, x0), by = _mm256_sub_pd(y2, y0), bz = _mm256_sub_pd(z2, z0);
+		__m256d cx = _mm256_sub_pd(x3, x0), cy = _mm256_sub_pd(y3, y0), cz = _mm256_sub_pd(z3, z0);
+
+		__m256d m0 = _mm256_fmsub_pd(by, cz, _mm256_mul_pd(bz, cy));
+		__m256d m1 = _mm256_fmsub_pd(bx, cz, _mm256_mul_pd(bz, cx));
+		__m256d m2 = _mm256_fmsub_pd(bx, cy, _mm256_mul_pd(by, cx));
+		__m256d det = _mm256_fmadd_pd(az, m2, _mm256_fmsub_pd(ax, m0, _mm256_mul_pd(ay, m1)));
+		_mm256_storeu_pd(jacobian + i, det);
+
+		_mm256_storeu_pd(centroid[0] + i, _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(x0, x1), _mm256_add_pd(x2, x3)), quarter));
+		_mm256_storeu_pd(centroid[1] + i, _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(y0, y1), _mm256_add_pd(y2, y3)), quarter));
+		_mm256_storeu_pd(centroid[2] + i, _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(z0, z1), _mm256_add_pd(z2, z3)), quarter));
+	}
+	tetrahedronScalar(c, i, last, jacobian, centroid);
+}
+
+// AVX-512 kernel for triangles in 2D, 8 elements per step
+MESH_TARGET_AVX512 
+void triangleAvx512(const double* const* c, size_t first, size_t last, double* jacobian, double* const* centroid) {
+	const __m512d third = _mm512_set1_pd(1.0 / 3);
+	size_t i = first;
+	for (; i + 8 <= last; i += 8) {
+		__m512d x0 = _mm512_loadu_pd(c[0] + i), y0 = _mm512_loadu_pd(c[1] + i);
+		__m512d x1 = _mm512_loadu_pd(c[2] + i), y1 = _mm512_loadu_pd(c[3] + i);
+		__m512d x2 = _mm512_loadu_pd(c[4] + i), y2 = _mm512_loadu_pd(c[5] + i);
+		__m512d ax = _mm512_sub_pd(x1, x0), ay = _mm512_sub_pd(y1, y0);
+		__m512d bx = _mm512_sub_pd(x2, x0), by = _mm512_sub_pd(y2, y0);
+		_mm512_storeu_pd(jacobian + i, _mm512_fmsub_pd(ax, by, _mm512_mul_pd(ay, bx)));
+		_mm512_storeu_pd(centroid[0] + i, _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(x0, x1), x2), third));
+		_mm512_storeu_pd(centroid[1] + i, _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(y0, y1), y2), third));
+	}
+	triangleScalar(c, i, last, jacobian, centroid);
+}
+
+// AVX-512 kernel for tetrahedra in 3D, 8 elements per step
+MESH_TARGET_AVX512 
+void tetrahedronAvx512(const double* const* c, size_t first, size_t last, double* jacobian, double* const* centroid) {
+	const __m512d quarter = _mm512_set1_pd(0.25);
+	size_t i = first;
+	for (; i + 8 <= last; i += 8) {
+		__m512d x0 = _mm512_loadu_pd(c[0] + i), y0 = _mm512_loadu_pd(c[1] + i), z0 = _mm512_loadu_pd(c[2] + i);
+		__m512d x1 = _mm512_loadu_pd(c[3] + i), y1 = _mm512_loadu_pd(c[4] + i), z1 = _mm512_loadu_pd(c[5] + i);
+		__m512d x2 = _mm512_loadu_pd(c[6] + i), y2 = _mm512_loadu_pd(c[7] + i), z2 = _mm512_loadu_pd(c[8] + i);
+		__m512d x3 = _mm512_loadu_pd(c[9] + i), y3 = _mm512_loadu_pd(c[10] + i), z3 = _mm512_loadu_pd(c[11] + i);
+
+		__m512d ax = _mm512_sub_pd(x1, x0), ay = _mm512_sub_pd(y1, y0), az = _mm512_sub_pd(z1, z0);
+		__m512d bx = _mm512_sub_pd(x2, x0), by = _mm512_sub_pd(y2, y0), bz = _mm512_sub_pd(z2, z0);
+		__m512d cx = _mm512_sub_pd(x3, x0), cy = _mm512_sub_pd(y3, y0), cz = _mm512_sub_pd(z3, z0);
+
+		__m512d m0 = _mm512_fmsub_pd(by, cz, _mm512_mul_pd(bz, cy));
+		__m512d m1 = _mm512_fmsub_pd(bx, cz, _mm512_mul_pd(bz, cx));
+		__m512d m2 = _mm512_fmsub_pd(bx, cy, _mm512_mul_pd(by, cx));
+		__m512d det = _mm512_fmadd_pd(az, m2, _mm512_fmsub_pd(ax, m0, _mm512_mul_pd(ay, m1)));
+		_mm512_storeu_pd(jacobian + i, det);
+
+		_mm512_storeu_pd(centroid[0] + i, _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(x0, x1), _mm512_add_pd(x2, x3)), quarter));
+		_mm512_storeu_pd(centroid[1] + i, _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(y0, y1), _mm512_add_pd(y2, y3)), quarter));
+		_mm512_storeu_pd(centroid[2] + i, _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(z0, z1), _mm512_add_pd(z2, z3)), quarter));
+	}
+	tetrahedronScalar(c, i, last, jacobian, centroid);
+}
+#endif
+
+} // namespace
+
+// best instruction set supported by the cpu (checked once at runtime)
+SimdLevel detectSimdLevel() {
+	static const SimdLevel level = [] {
+#if defined(MESH_SIMD_X86) && defined(_MSC_VER)
+		int info[4]{};
+		__cpuid(info, 1);
+		bool fma = info[2] & (1 << 12);
+		bool osxsave = info[2] & (1 << 27);
+		if (!osxsave) return SimdLevel::Scalar;
+
+		// the OS has to save the ymm (and zmm) registers
+		unsigned long long xcr = _xgetbv(0);
+		__cpuidex(info, 7, 0);
+		if ((info[1] & (1 << 16)) && (xcr & 0xe6) == 0xe6) return SimdLevel::Avx512;
+		if ((info[1] & (1 << 5)) && fma && (xcr & 0x6) == 0x6) return SimdLevel::Avx2;
+		return SimdLevel::Scalar;
+#elif defined(MESH_SIMD_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) return SimdLevel::Avx512;
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::Avx2;
+		return SimdLevel::Scalar;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}();
+	return level;
+}
+
+// compute jacobians, measures and centroids of all finite elements at once, bucket by bucket
+ElementGeometry computeGeometry(const FrozenMesh& mesh, ThreadPool& pool, SimdLevel level) {
+	size_t dim = mesh.spaceDim();
+	const std::vector<FiniteElement>& elements = mesh.getFiniteElements();
+	size_t n = elements.size();
+
+	// never run a kernel the cpu doesn't have
+	SimdLevel supported = detectSimdLevel();
+	if (level == SimdLevel::Auto || level > supported) level = supported;
+
+	Kernel kernel = nullptr;
+	if (dim == 2) kernel = triangleScalar;
+	if (dim == 3) kernel = tetrahedronScalar;
+#ifdef MESH_SIMD_X86
+	if (dim == 2 && level == SimdLevel::Avx2) kernel = triangleAvx2;
+	if (dim == 3 && level == SimdLevel::Avx2) kernel = tetrahedronAvx2;
+	if (dim == 2 && level == SimdLevel::Avx512) kernel = triangleAvx512;
+	if (dim == 3 && level == SimdLevel::Avx512) kernel = tetrahedronAvx512;
+#else
+	level = SimdLevel::Scalar;
+#endif
+
+	ElementGeometry res{};
+	res._level = kernel ? level : SimdLevel::Scalar;
+	res._ids.resize(n);
+	res._jacobian.assign(n, 0);
+	res._measure.assign(n, 0);
+	res._centroid.assign(n * dim, 0);
+	for (size_t i = 0; i < n; ++i) res._ids[i] = elements[i]._id;
+
+	// elements with a jacobian, the rest only get the centroid of the nodes that are present
+	std::vector<char> measured(n);
+	auto nodeCentroid = [&](size_t i) {
+		size_t found = 0;
+		for (const size_t& id : elements[i]._nodeIDvec) {
+			const Node* node = mesh.findNode(id);
+			if (!node) continue;
+			for (size_t d = 0; d < dim; ++d) res._centroid[i * dim + d] += node->_coords[d];
+			found++;
+		}
+		for (size_t d = 0; d < dim && found; ++d) res._centroid[i * dim + d] /= static_cast<double>(found);
+	};
+
+	ElementType simplex = dim == 2 ? ElementType::Triangle : dim == 3 ? ElementType::Tetrahedron : ElementType::Unknown;
+	size_t vertices = dim + 1;
+	double factor = dim == 2 ? 0.5 : 1.0 / 6;
+
+	for (const ElementBucket& bucket : mesh.finiteBuckets()._buckets) {
+		size_t m = bucket.size();
+
+		// simplices of the space: vertex coordinates are gathered into SoA arrays for the kernel
+		if (kernel && bucket._type == simplex) {
+			std::vector<double> soa(vertices * dim * m);
+			std::vector<double> centroidSoa(dim * m);
+			std::vector<double> jacobian(m);
+			std::vector<const double*> coords(vertices * dim);
+			std::vector<double*> centroid(dim);
+			for (size_t k = 0; k < coords.size(); ++k) coords[k] = soa.data() + k * m;
+			for (size_t d = 0; d < dim; ++d) centroid[d] = centroidSoa.data() + d * m;
+			std::vector<char> found(m);
+
+			pool.parallelFor(m, pool.size() * 4, [&](size_t, size_t first, size_t last) {
+				// gather
+				for (size_t k = first; k < last; ++k) {
+					std::span<const size_t> ids = bucket.nodes(k);
+					found[k] = true;
+					for (size_t v = 0; v < vertices; ++v) {
+						const Node* node = mesh.findNode(ids[v]);
+						if (!node) { found[k] = false; break; }
+						for (size_t d = 0; d < dim; ++d) soa[(v * dim + d) * m + k] = node->_coords[d];
+					}
+				}
+
+				kernel(coords.data(), first, last, jacobian.data(), centroid.data());
+
+				// scatter
+				for (size_t k = first; k < last; ++k) {
+					size_t i = bucket._positions[k];
+					if (!found[k]) { nodeCentroid(i); continue; }
+					measured[i] = true;
+					res._jacobian[i] = jacobian[k];
+					res._measure[i] = std::abs(jacobian[k]) * factor;
+					for (size_t d = 0; d < dim; ++d) res._centroid[i * dim + d] = centroid[d][k];
+				}
+			});
+			continue;
+		}
+
+		// other shapes of the space dimension: scalar kernel over the corner vertices
+		size_t corners = elementDimension(bucket._type) == dim ? vertexCount(bucket._type) : 0;
+		double reference = referenceMeasure(bucket._type);
+
+		pool.parallelFor(m, pool.size() * 4, [&](size_t, size_t first, size_t last) {
+			std::vector<std::array<double, 3>> p(corners);
+			for (size_t k = first; k < last; ++k) {
+				size_t i = bucket._positions[k];
+				std::span<const size_t> ids = bucket.nodes(k);
+
+				bool found = corners > 0;
+				for (size_t v = 0; v < corners && found; ++v) {
+					const Node* node = mesh.findNode(ids[v]);
+					found = node != nullptr;
+					for (size_t d = 0; d < dim && found; ++d) p[v][d] = node->_coords[d];
+				}
+				if (!found) { nodeCentroid(i); continue; }
+
+				double measure = signedMeasure(bucket._type, p, dim);
+				measured[i] = true;
+				res._jacobian[i] = measure / reference;
+				res._measure[i] = std::abs(measure);
+				for (size_t v = 0; v < corners; ++v)
+					for (size_t d = 0; d < dim; ++d) res._centroid[i * dim + d] += p[v][d] / static_cast<double>(corners);
+			}
+		});
+	}
+
+	// meshers differ in vertex ordering, so the orientation of the majority is taken as valid
+	size_t positive = 0, negative = 0;
+	for (size_t i = 0; i < n; ++i) {
+		if (!measured[i]) continue;
+		if (res._jacobian[i] > 0) positive++;
+		if (res._jacobian[i] < 0) negative++;
+	}
+	res._sign = positive >= negative ? 1 : -1;
+
+	for (size_t i = 0; i < n; ++i)
+		if (measured[i] && res._jacobian[i] * res._sign <= 0) res._inverted.push_back(res._ids[i]);
+
+	return res;
+}
@@ -0,0 +1,46 @@
+#include "Incidence.h"
+
+// positions of the elements using all of the node positions (sorted, every element once)
+std::vector<size_t> NodeIncidence::intersect(std::span<const size_t> nodes) const {
+	std::vector<size_t> res, scratch;
+	intersect(nodes, res, scratch);
+	return res;
+}
+
+// intersect appending to a buffer, the scratch buffer is kept by the caller between calls
+void NodeIncidence::intersect(std::span<const size_t> nodes,
+			      std::vector<size_t>& out,
+			      std::vector<size_t>& scratch) const {
+	if (nodes.empty()) return;
+
+	size_t before = out.size();
+	if (nodes.size() == 1) {
+		std::span<const size_t> list = elementsOf(nodes[0]);
+		out.insert(end(out), begin(list), end(list));
+	}
+	else std::ranges::set_intersection(elementsOf(nodes[0]), elementsOf(nodes[1]), std::back_inserter(out));
+
+	// further lists are intersected with the tail of out through the scratch buffer,
+	// the output of set_intersection must not overlap its inputs
+	for (size_t k = 2; k < nodes.size(); ++k) {
+		std::span<const size_t> list = elementsOf(nodes[k]);
+		scratch.clear();
+		std::ranges::set_intersection(begin(out) + before, end(out), begin(list), end(list), std::back_inserter(scratch));
+		out.resize(before);
+		out.insert(end(out), begin(scratch), end(scratch));
+	}
+
+	// an element listing the same node twice is counted once
+	out.erase(std::unique(begin(out) + before, end(out)), end(out));
+}
+
+// checks the node positions of an element query
+Expected<void> checkQueryNodes(std::span<const size_t> nodes, bool vertices, const std::function<bool(size_t)>& isVertex) {
+	if (std::ranges::count(nodes, NodeIncidence::npos))
+		return MeshError{ ErrorCode::MissingNode, 0, 0, "One or more nodes are not present in the loaded data" };
+
+	if (vertices && !std::ranges::all_of(nodes, isVertex))
+		return MeshError{ ErrorCode::NotVertex, 0, 0, "Not all nodes are vertices" };
+
+	return {};
+}
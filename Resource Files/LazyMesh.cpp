@@ -0,0 +1,299 @@
+#include "LazyMesh.h"
+
+#include <filesystem>
+#include <cstring>
+
+namespace {
+
+// first bytes of a sidecar index
+constexpr char sidecarMagic[8] = { 'A', 'N', 'E', 'U', 'I', 'D', 'X', '1' };
+
+} // namespace
+
+// constructor (builds or reads the block index)
+LazyMeshLoader::LazyMeshLoader(const std::string& path, const LazyOptions& options) : _path(path), _options(options) {
+	if (_options._checkpointInterval == 0) _options._checkpointInterval = 1;
+	if (_options._cachePages == 0) _options._cachePages = 1;
+
+	_file.open(path, std::ios_base::in | std::ios_base::binary);
+	if (!_file.is_open())
+		throw Exception("Unable to open file at specified path: " + path);
+
+	if (detectCompression(_file) != Compression::None)
+		throw Exception("Lazy loading needs an uncompressed file: " + path);
+
+	_fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+
+	std::string sidecar = path + ".idx";
+	if (!(_options._useSidecar && readSidecar(sidecar))) {
+		buildIndex();
+		if (_options._useSidecar) writeSidecar(sidecar);
+	}
+
+	// block headers and the first line of every block
+	auto line = [this](size_t number) {
+		if (number >= _lines)
+			throw Exception("Unexpected end of file: " + _path);
+		return readLines(number / _options._checkpointInterval)[number % _options._checkpointInterval];
+	};
+
+	_nodes = std::stoull(splice(line(0))[0]);
+	if (_nodes) _spaceDimension = splice(line(1)).size();
+
+	_finiteElements = std::stoull(splice(line(_nodes + 1))[0]);
+	if (_finiteElements) _amountOfNodesInOneFiniteElement = splice(line(_nodes + 2)).size() - 1;
+
+	size_t boundaryHeader = _nodes + _finiteElements + 2;
+	if (boundaryHeader < _lines) {
+		_boundaryElements = std::stoull(splice(line(boundaryHeader))[0]);
+		if (_boundaryElements) _amountOfNodesInOneBoundaryElement = splice(line(boundaryHeader + 1)).size() - 1;
+	}
+}
+
+// newline pass over the whole file
+void LazyMeshLoader::buildIndex() {
+	std::vector<char> buffer(1 << 20);
+	uint64_t offset = 0;
+	_lines = 0;
+	_checkpoints.clear();
+
+	_file.clear();
+	_file.seekg(0);
+	bool lineStart = true;
+
+	for (;;) {
+		_file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		size_t got = static_cast<size_t>(_file.gcount());
+		if (got == 0) break;
+
+		const char* data = buffer.data();
+		for (size_t i = 0; i < got;) {
+			if (lineStart) {
+				if (_lines % _options._checkpointInterval == 0) _checkpoints.push_back(offset + i);
+				_lines++;
+				lineStart = false;
+			}
+			const char* end = static_cast<const char*>(std::memchr(data + i, '\n', got - i));
+			if (!end) break;
+			i = static_cast<size_t>(end - data) + 1;
+			lineStart = true;
+		}
+		offset += got;
+	}
+
+	_checkpoints.push_back(offset);
+	_file.clear();
+}
+
+// sidecar index, true if it was read and matches the file
+bool LazyMeshLoader::readSidecar(const std::string& sidecar) {
+	std::error_code error;
+	if (!std::filesystem::exists(sidecar, error) ||
+	    std::filesystem::last_write_time(sidecar, error) < std::filesystem::last_write_time(_path, error))
+		return false;
+
+	std::ifstream in(sidecar, std::ios_base::binary);
+	char magic[8]{};
+	uint64_t header[4]{}; // file size, interval, lines, checkpoints
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!in || std::memcmp(magic, sidecarMagic, sizeof(magic)) != 0 ||
+	    header[0] != _fileSize || header[1] != _options._checkpointInterval)
+		return false;
+
+	_lines = static_cast<size_t>(header[2]);
+	_checkpoints.resize(static_cast<size_t>(header[3]));
+	in.read(reinterpret_cast<char*>(_checkpoints.data()), static_cast<std::streamsize>(_checkpoints.size() * sizeof(uint64_t)));
+	return static_cast<bool>(in);
+}
+
+void LazyMeshLoader::writeSidecar(const std::string& sidecar) const {
+	std::ofstream out(sidecar, std::ios_base::binary | std::ios_base::trunc);
+	if (!out.is_open()) return; // the index is an optimization only
+
+	uint64_t header[4] = { _fileSize, _options._checkpointInterval, _lines, _checkpoints.size() };
+	out.write(sidecarMagic, sizeof(sidecarMagic));
+	out.write(reinterpret_cast<const char*>(header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(_checkpoints.data()), static_cast<std::streamsize>(_checkpoints.size() * sizeof(uint64_t)));
+}
+
+// raw lines of a page
+std::vector<std::string> LazyMeshLoader::readLines(size_t index) const {
+	if (index + 1 >= _checkpoints.size())
+		throw Exception("Page is out of range in " + _path);
+
+	std::string bytes(static_cast<size_t>(_checkpoints[index + 1] - _checkpoints[index]), '\0');
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_file.clear();
+		_file.seekg(static_cast<std::streamoff>(_checkpoints[index]));
+		_file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	std::vector<std::string> res;
+	size_t start = 0;
+	while (start < bytes.size()) {
+		size_t end = bytes.find('\n', start);
+		if (end == std::string::npos) end = bytes.size();
+		res.emplace_back(bytes, start, end - start);
+		start = end + 1;
+	}
+	return res;
+}
+
+// page through the LRU cache
+std::shared_ptr<const LazyMeshLoader::Page> LazyMeshLoader::page(size_t index, bool keep) const {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _cache.find(index);
+		if (it != end(_cache)) {
+			if (keep) _lru.splice(begin(_lru), _lru, it->second);
+			return it->second->second;
+		}
+	}
+
+	// parsed outside of the lock, two threads may parse the same page once each
+	auto res = std::make_shared<Page>();
+	std::vector<std::string> lines = readLines(index);
+	size_t first = index * _options._checkpointInterval;
+	size_t finiteFirst = _nodes + 2, boundaryFirst = _nodes + _finiteElements + 3;
+
+	for (size_t i = 0; i < lines.size(); ++i) {
+		size_t number = first + i;
+		if (number >= 1 && number <= _nodes) {
+			std::vector<std::string> coords = splice(lines[i]);
+			Node node(coords.size());
+			node._id = number;
+			std::ranges::transform(coords, begin(node._coords), 
+				[](const std::string& coord) { return std::stod(coord); });
+			res->_nodes.push_back(std::move(node));
+		}
+		else if (number >= finiteFirst && number < finiteFirst + _finiteElements) {
+			std::vector<std::string> ids = splice(lines[i]);
+			FiniteElement el{};
+			el._id = number - finiteFirst + 1;
+			el._material_area_id = std::stoull(ids[0]);
+			for (size_t j = 1; j < ids.size(); ++j) el._nodeIDvec.push_back(std::stoull(ids[j]));
+			res->_finiteElements.push_back(std::move(el));
+		}
+		else if (number >= boundaryFirst && number < boundaryFirst + _boundaryElements) {
+			std::vector<std::string> ids = splice(lines[i]);
+			BoundaryElement el{};
+			el._id = _finiteElements + number - boundaryFirst + 1;
+			el._surface_area_id = std::stoull(ids[0]);
+			for (size_t j = 1; j < ids.size(); ++j) el._nodeIDvec.push_back(std::stoull(ids[j]));
+			res->_boundaryElements.push_back(std::move(el));
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_pagesParsed++;
+	if (!keep) return res;
+	auto it = _cache.find(index);
+	if (it != end(_cache)) return it->second->second;
+
+	_lru.emplace_front(index, res);
+	_cache[index] = begin(_lru);
+	if (_lru.size() > _options._cachePages) {
+		_cache.erase(_lru.back().first);
+		_lru.pop_back();
+	}
+	return res;
+}
+
+// pages with the lines first .. last - 1 one after another
+void LazyMeshLoader::scanPages(size_t first, size_t last, const std::function<void(const Page&)>& body) const {
+	for (size_t index = first / _options._checkpointInterval; 
+	     index * _options._checkpointInterval < last; ++index)
+		body(*page(index, false));
+}
+
+// getter Node by id
+Node LazyMeshLoader::getNode(size_t id) const {
+	if (id == 0 || id > _nodes)
+		throw Exception("Node " + std::to_string(id) + " is not present in the loaded data");
+
+	size_t line = nodeLine(id);
+	size_t index = line / _options._checkpointInterval;
+	size_t first = std::max<size_t>(index * _options._checkpointInterval, 1);
+	Node res = page(index)->_nodes.at(line - first);
+
+	// the vertex flag needs every element, it is not known in lazy mode
+	res._is_vertex = false;
+	return res;
+}
+
+// getter Finite Element by id
+FiniteElement LazyMeshLoader::getFiniteElement(size_t id) const {
+	if (id == 0 || id > _finiteElements)
+		throw Exception("Finite element " + std::to_string(id) + " is not present in the loaded data");
+
+	size_t line = finiteElementLine(id);
+	size_t index = line / _options._checkpointInterval;
+	size_t first = std::max(index * _options._checkpointInterval, _nodes + 2);
+	return page(index)->_finiteElements.at(line - first);
+}
+
+// getter Boundary Element by id
+BoundaryElement LazyMeshLoader::getBoundaryElement(size_t id) const {
+	if (id <= _finiteElements || id > _finiteElements + _boundaryElements)
+		throw Exception("Boundary element " + std::to_string(id) + " is not present in the loaded data");
+
+	size_t line = boundaryElementLine(id);
+	size_t index = line / _options._checkpointInterval;
+	size_t first = std::max(index * _options._checkpointInterval, _nodes + _finiteElements + 3);
+	return page(index)->_boundaryElements.at(line - first);
+}
+
+// getter for a range of Finite Elements {first id, amount}
+std::vector<FiniteElement> LazyMeshLoader::getFiniteElements(size_t first, size_t amount) const {
+	std::vector<FiniteElement> res{};
+	if (first == 0 || first > _finiteElements) return res;
+	size_t last = std::min(first + amount, _finiteElements + 1);
+
+	for (size_t id = first; id < last;) {
+		size_t index = finiteElementLine(id) / _options._checkpointInterval;
+		std::shared_ptr<const Page> current = page(index);
+		for (const FiniteElement& el : current->_finiteElements)
+			if (el._id >= id && el._id < last) res.push_back(el);
+		id = res.empty() ? last : res.back()._id + 1;
+	}
+	return res;
+}
+
+// method for finding Finite Elements by 2 Node ids
+std::vector<FiniteElement> LazyMeshLoader::findFiniteElementsByEdges(size_t node1id, size_t node2id) const {
+	if (node1id == 0 || node1id > _nodes || node2id == 0 || node2id > _nodes)
+		throw Exception("One or more nodes are not present in the loaded data");
+
+	std::vector<FiniteElement> res{};
+	size_t first = finiteElementLine(1);
+	scanPages(first, first + _finiteElements, [&](const Page& current) {
+		for (const FiniteElement& el : current._finiteElements)
+			if (std::ranges::find(el._nodeIDvec, node1id) != end(el._nodeIDvec) &&
+			    std::ranges::find(el._nodeIDvec, node2id) != end(el._nodeIDvec)) res.push_back(el);
+	});
+	return res;
+}
+
+// method for finding Finite Elements by a material ID
+std::vector<FiniteElement> LazyMeshLoader::findFiniteElementsByMaterialID(size_t materialid) const {
+	std::vector<FiniteElement> res{};
+	size_t first = finiteElementLine(1);
+	scanPages(first, first + _finiteElements, [&](const Page& current) {
+		for (const FiniteElement& el : current._finiteElements)
+			if (el._material_area_id == materialid) res.push_back(el);
+	});
+	return res;
+}
+
+// method for finding Boundary Elements by an area ID
+std::vector<BoundaryElement> LazyMeshLoader::findBoundaryElementsByAreaID(size_t areaid) const {
+	std::vector<BoundaryElement> res{};
+	size_t first = boundaryElementLine(_finiteElements + 1);
+	scanPages(first, first + _boundaryElements, [&](const Page& current) {
+		for (const BoundaryElement& el : current._boundaryElements)
+			if (el._surface_area_id == areaid) res.push_back(el);
+	});
+	return res;
+}
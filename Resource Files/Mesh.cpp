@@ -1,4 +1,53 @@
+#include <charconv>
+
 #include "Mesh.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// tokens of one line (separated like in splice), parsed in place with from_chars
+class LineParser {
+public:
+	explicit LineParser(std::string_view line) : _line(line) {}
+
+	// amount of tokens after the current position
+	size_t count() const {
+		size_t res = 0;
+		for (size_t i = _end; i < _line.size(); ++i)
+			if (!separator(_line[i]) && (i == _end || separator(_line[i - 1]))) res++;
+		return res;
+	}
+
+	// parse the next token, false if there is none or it isn't a whole number of type T
+	template <class T>
+	bool next(T& value) {
+		_start = _end;
+		while (_start < _line.size() && separator(_line[_start])) _start++;
+		_end = _start;
+		while (_end < _line.size() && !separator(_line[_end])) _end++;
+		if (_start == _end) return false;
+
+		const char* first = _line.data() + _start;
+		const char* last = _line.data() + _end;
+		if (*first == '+' && last - first > 1) first++;
+		auto [ptr, ec] = std::from_chars(first, last, value);
+		return ec == std::errc{} && ptr == last;
+	}
+
+	// position of the last token in the line
+	size_t position() const { return _start; }
+
+	// last token
+	std::string_view token() const { return _line.substr(_start, _end - _start); }
+private:
+	static bool separator(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\\'; }
+
+	std::string_view _line;
+	size_t _start{};
+	size_t _end{};
+};
+
+} // namespace
 
 // Method definitions --- --- ---
 
@@ -6,114 +55,494 @@
 // 
 // definition for loadMesh method in a derived class for the files with type *.neu
 void AneuMeshLoader::loadMesh(const std::string& path, bool neu) {
+	load(path, neu).value();
+}
+
+// definition for the path of the *.aneu written for a *.neu file
+std::string AneuMeshLoader::NeuToAneuPath(const std::string& path) {
+	std::vector<std::string> parts = splice(path);
+	std::string res = parts.empty() ? path : parts.back();
+	if (res.size() >= 3) res.erase(res.size() - 3);
+	return res + "aneu";
+}
+
+// definition for loadMesh without exceptions
+Expected<void> AneuMeshLoader::tryLoadMesh(const std::string& path, bool neu) noexcept {
+	// only failures below the parser (reader thread, decompression, allocation) are thrown
+	try {
+		return load(path, neu);
+	}
+	catch (const std::exception& error) {
+		return MeshError{ ErrorCode::Io, 0, 0, error.what() };
+	}
+}
+
+// definition for the shared part of loadMesh and tryLoadMesh
+Expected<void> AneuMeshLoader::load(const std::string& path, bool neu) {
 
 	std::fstream filename(path, std::ios_base::in |
 		                    std::ios_base::binary);
 
 	if (!filename.is_open())
-		throw Exception("Unable to open file at specified path: " + path);
+		return MeshError{ ErrorCode::OpenFailed, 0, 0, "Unable to open file at specified path: " + path };
+
+	// compressed *.neu is parsed directly, the line layout is the same as *.aneu
+	// (writing the decompressed *.aneu next to it would double the disk I/O)
+	Compression compression = detectCompression(filename);
 
-	if (neu) {
-		size_t size{};
-		std::vector < std::string > anuenamevec = splice(path);
-		std::string aneuname = anuenamevec[anuenamevec.size() - 1];
-		size = aneuname.size();
-		aneuname.erase(size - 3);
-		aneuname += "aneu";
-		filename = AneuMeshLoader::NeuToAneu(filename, aneuname);
+	if (neu && compression == Compression::None) {
+		filename = AneuMeshLoader::NeuToAneu(filename, NeuToAneuPath(path));
 
 		if (!filename.is_open())
-			throw Exception("Unable to open file at specified path: " + path);
+			return MeshError{ ErrorCode::OpenFailed, 0, 0, "Unable to open file at specified path: " + path };
+	}
+
+	// progress is reported every progressLines lines, the file size is taken before the reader starts
+	constexpr size_t progressLines = 4096;
+	const std::function<bool(const LoadProgress&)>& report = _loadOptions._progress;
+	LoadProgress progress{};
+	if (report) {
+		std::streampos start = filename.tellg();
+		filename.seekg(0, std::ios_base::end);
+		progress._fileSize = static_cast<size_t>(filename.tellg());
+		filename.seekg(start);
 	}
 
 	std::string line;
+	BufferedReader reader(filename, _readerOptions, compression);
+
+	// problems found while parsing (only with _validate), line numbers are 1-based
+	_validation = {};
+	std::vector<ValidationIssue> issues;
+	bool validating = _loadOptions._validate;
+	ValidationBlock finiteBlock, boundaryBlock;
+
+	// records skipped in the lenient mode
+	_skippedRecords.clear();
+	bool lenient = _loadOptions._lenient;
+	bool mixed = _loadOptions._mixedElements;
+
+	// error that stops the loading
+	std::optional<MeshError> fatal;
+
+	// position of the current line, a cancelled load looks like the end of the file with fatal set
+	size_t lineNumber = 0, lineOffset = 0;
+	auto nextLine = [&] {
+		lineOffset = reader.bytesConsumed();
+		lineNumber++;
+		if (report && lineNumber % progressLines == 0) {
+			progress._bytes = lineOffset;
+			if (!report(progress)) {
+				fatal = MeshError{ ErrorCode::Cancelled, lineOffset, lineNumber, "Loading was cancelled" };
+				return false;
+			}
+		}
+		return reader.getline(line);
+	};
+	auto error = [&](ErrorCode code, const LineParser& parser, std::string message) {
+		return MeshError{ code, lineOffset + parser.position(), lineNumber, std::move(message) };
+	};
+
+	// amount in front of a block and the optional second column (0 if there is none),
+	// nullopt with the error in fatal otherwise
+	auto readHeader = [&](const char* block) -> std::optional<std::pair<size_t, size_t>> {
+		if (!nextLine()) {
+			if (!fatal) fatal = error(ErrorCode::UnexpectedEnd, LineParser(""), std::string("Missing ") + block + " header");
+			return std::nullopt;
+		}
+		LineParser parser(line);
+		size_t amount{}, second{};
+		if (!parser.next(amount)) {
+			fatal = error(ErrorCode::BadHeader, parser, std::string("Expected the amount of ") + block);
+			return std::nullopt;
+		}
+		if (!parser.next(second)) second = 0;
+		return std::pair{ amount, second };
+	};
+
+	// a bad record stops the loading or is skipped in the lenient mode
+	auto reject = [&](MeshError&& err) {
+		if (lenient) _skippedRecords.push_back(std::move(err));
+		else fatal = std::move(err);
+	};
+	auto truncated = [&](const char* block) {
+		if (fatal) return;
+		MeshError err = error(ErrorCode::UnexpectedEnd, LineParser(""), std::string("File ends inside the ") + block + " block");
+		if (lenient) _skippedRecords.push_back(std::move(err));
+		else fatal = std::move(err);
+	};
 
 	// reading nodes
-	std::getline(filename, line);
-	size_t nodesAmount = std::stoull(splice(line)[0]);
+	std::optional<std::pair<size_t, size_t>> nodesHeader = readHeader("nodes");
+	if (!nodesHeader) return *fatal;
+	size_t nodesAmount = nodesHeader->first;
 
 	size_t curr_id = 1;
-	for (size_t i = 0; i < nodesAmount; ++i) {
-		std::getline(filename, line);
-		if (i == 0) _spaceDimension = splice(line).size();
+	bool ended = false;
+	_nodesMap.reserve(_nodesMap.size() + nodesAmount);
+	for (size_t i = 0; i < nodesAmount; ++i, ++curr_id) {
+		progress._nodes = i;
+		if (!nextLine()) {
+			truncated("nodes");
+			ended = true;
+			break;
+		}
+		LineParser parser(line);
+		size_t columns = parser.count();
+		if (i == 0) _spaceDimension = columns;
+
+		if (validating && columns != _spaceDimension)
+			issues.push_back({ ValidationCheck::ColumnCount, lineNumber, curr_id,
+					   std::to_string(columns) + " coordinates instead of " + std::to_string(_spaceDimension) });
+
+		// extra coordinates are ignored, missing ones stay 0
 		Node currNode(_spaceDimension);
 		currNode._id = curr_id;
 		currNode._is_vertex = false;
-		std::vector<std::string> coords = splice(line);
 
-		std::ranges::transform(coords, begin(currNode._coords),
-			[](const std::string& coord) {
-				return std::stod(coord);
-			});
+		bool parsed = true;
+		for (size_t j = 0; j < std::min(columns, _spaceDimension) && parsed; ++j) parsed = parser.next(currNode._coords[j]);
+		if (!parsed) {
+			reject(error(ErrorCode::BadNumber, parser, "Malformed coordinate '" + std::string(parser.token()) + "' of node " + std::to_string(curr_id)));
+			if (fatal) return *fatal;
+			continue;
+		}
 
-		_nodesMap[curr_id] = currNode;
-		curr_id++;
+		// the node is moved into the map, not copied
+		_nodesMap.insert_or_assign(curr_id, std::move(currNode));
 	}
+	if (fatal) return *fatal;
+	progress._nodes = nodesAmount;
 	curr_id = 1;
 
-	auto loadMeshUtil = [this, &line, &curr_id]<class Element>(std::fstream & filename, Element el) {
+	auto loadMeshUtil = [&]<class Element>(Element el) {
+		constexpr bool isFinite = std::is_same_v<Element, FiniteElement>;
+		const char* block = isFinite ? "finite elements" : "boundary elements";
+
 		// reading FE/BE elements
-		std::getline(filename, line);
+		std::optional<std::pair<size_t, size_t>> header = readHeader(block);
+		if (!header) return;
+		auto [amount, headerArity] = *header;
 
-		size_t amount{};
-		if constexpr (std::is_same_v<Element, FiniteElement>)
-			amount = std::stoull(splice(line)[0]);
+		if constexpr (isFinite)
+			_finiteElementsSet.reserve(_finiteElementsSet.size() + amount);
 		else
-			amount = std::stoull(splice(line)[0]);
-
-		for (size_t i = 0; i < amount; ++i) {
-			std::getline(filename, line);
-			// getting amount of nodes in one (surface) finite element
-			if (i == 0) {
-				if constexpr (std::is_same_v<Element, FiniteElement>)
-					_amountOfNodesInOneFiniteElement = splice(line).size() - 1;
-				else
-					_amountOfNodesInOneBoundaryElement = splice(line).size() - 1;
+			_boundaryElementsSet.reserve(_boundaryElementsSet.size() + amount);
+
+		const std::unordered_set<size_t>* areaIds{};
+		if constexpr (isFinite) {
+			areaIds = &_loadOptions._materialIds;
+
+			// lines of a skipped block are read but not parsed, ids stay the same
+			if (_loadOptions._skipFiniteElements) {
+				for (size_t i = 0; i < amount; ++i, ++curr_id, ++progress._elements)
+					if (!nextLine()) {
+						truncated(block);
+						ended = true;
+						return;
+					}
+				return;
+			}
+		}
+		else areaIds = &_loadOptions._surfaceIds;
+
+		// amount of nodes in one (surface) finite element: the arity column of the header,
+		// otherwise the first element accepted (mixed blocks keep the widest one)
+		size_t& arity = isFinite ? _amountOfNodesInOneFiniteElement : _amountOfNodesInOneBoundaryElement;
+		arity = headerArity;
+		bool arityKnown = headerArity != 0;
+
+		for (size_t i = 0; i < amount; ++i, ++curr_id, ++progress._elements) {
+			if (!nextLine()) {
+				truncated(block);
+				ended = true;
+				return;
+			}
+			LineParser parser(line);
+			size_t columns = parser.count();
+
+			size_t areaId{};
+			if (!parser.next(areaId)) {
+				reject(error(columns ? ErrorCode::BadNumber : ErrorCode::BadRecord, parser,
+					     "Malformed area id '" + std::string(parser.token()) + "' of element " + std::to_string(curr_id)));
+				if (fatal) return;
+				continue;
 			}
-			// finite elements
-			if constexpr (std::is_same_v<Element, FiniteElement>) {
-				FiniteElement currFiniteElement{};
-				currFiniteElement._id = curr_id;
-				std::vector<std::string> ids = splice(line);
-				currFiniteElement._material_area_id = std::stoull(ids[0]);
-
-				for (size_t j = 1; j < ids.size(); ++j) {
-					size_t currNodeID = std::stoull(ids[j]);
-					currFiniteElement._nodeIDvec.push_back(currNodeID);
-					if (_nodesMap.contains(currNodeID)) _nodesMap[currNodeID]._is_vertex = true;
+
+			// only the area id is parsed for filtered out elements
+			if (!areaIds->empty() && !areaIds->contains(areaId)) continue;
+
+			if (!mixed && arityKnown && columns - 1 != arity) {
+				// elements of another arity are kept unless they are skipped
+				if (lenient) {
+					reject(error(ErrorCode::BadRecord, parser, std::to_string(columns - 1) + " nodes instead of " +
+						     std::to_string(arity) + " in element " + std::to_string(curr_id)));
+					continue;
 				}
+				if (validating)
+					issues.push_back({ ValidationCheck::Arity, lineNumber, curr_id,
+							   std::to_string(columns - 1) + " nodes instead of " + std::to_string(arity) });
+			}
 
-				_finiteElementsSet.insert(currFiniteElement);
+			Element currElement{};
+			currElement._id = curr_id;
+			if constexpr (isFinite) currElement._material_area_id = areaId;
+			else currElement._surface_area_id = areaId;
+
+			currElement._nodeIDvec.resize(columns - 1);
+			bool parsed = true;
+			for (size_t j = 0; j + 1 < columns && parsed; ++j) parsed = parser.next(currElement._nodeIDvec[j]);
+			if (!parsed) {
+				reject(error(ErrorCode::BadNumber, parser, "Malformed node id '" + std::string(parser.token()) + "' in element " + std::to_string(curr_id)));
+				if (fatal) return;
+				continue;
+			}
+
+			// a rejected record doesn't set the arity, the next one taken does
+			if (mixed) arity = std::max(arity, columns - 1);
+			else if (!arityKnown) arity = columns - 1;
+			arityKnown = true;
+
+			for (const size_t& currNodeID : currElement._nodeIDvec) {
+				auto node = _nodesMap.find(currNodeID);
+				if (node != end(_nodesMap)) node->second._is_vertex = true;
+				else if (validating)
+					issues.push_back({ ValidationCheck::MissingNode, lineNumber, curr_id,
+							   "node " + std::to_string(currNodeID) + " is not defined" });
 			}
-			// surface finite elements
-			else {
-				BoundaryElement currSurfaceFiniteElement{};
-				currSurfaceFiniteElement._id = curr_id;
-				std::vector<std::string> ids = splice(line);
-				currSurfaceFiniteElement._surface_area_id = std::stoull(ids[0]);
-
-				for (size_t j = 1; j < ids.size(); ++j) {
-					size_t currNodeID = std::stoull(ids[j]);
-					currSurfaceFiniteElement._nodeIDvec.push_back(currNodeID);
-					if (_nodesMap.contains(currNodeID)) _nodesMap[currNodeID]._is_vertex = true;
-				}
 
-				_boundaryElementsSet.insert(currSurfaceFiniteElement);
+			// nodes of this file are 1..nodesAmount, they are recorded as positions from 0
+			if (validating) {
+				ValidationBlock& record = isFinite ? finiteBlock : boundaryBlock;
+				if (record._ids.empty()) {
+					record._ids.reserve(amount);
+					record._offsets.reserve(amount);
+					record._nodes.reserve(amount * currElement._nodeIDvec.size());
+				}
+				record._ids.push_back(curr_id);
+				for (const size_t& id : currElement._nodeIDvec) record._nodes.push_back(id - 1 < nodesAmount ? id - 1 : nodesAmount);
+				record._offsets.push_back(record._nodes.size());
 			}
-			curr_id++;
+
+			if constexpr (isFinite) _finiteElementsSet.insert(std::move(currElement));
+			else _boundaryElementsSet.insert(std::move(currElement));
 		}
 	};
 
 	FiniteElement FEblank{}; BoundaryElement SFEblank{};
-	loadMeshUtil(filename, FEblank);
-	loadMeshUtil(filename, SFEblank);
+	if (!ended) loadMeshUtil(FEblank);
+	if (fatal) return *fatal;
+	if (!ended && !_loadOptions._skipBoundaryElements) loadMeshUtil(SFEblank);
+	if (fatal) return *fatal;
+
+	if (validating) {
+		_validation.merge(std::move(issues));
+		validate(nodesAmount, finiteBlock, boundaryBlock);
+	}
 
-	filename.close();
+	if (_loadOptions._compactNodes) compactNodes();
+
+	if (_reorderStrategy != ReorderStrategy::None) {
+		_renumbering = computeRenumbering(*this, _reorderStrategy);
+		renumber(_renumbering);
+	}
+
+	// the last report has the whole file, it can't cancel anymore
+	if (report) {
+		progress._bytes = reader.bytesConsumed();
+		report(progress);
+	}
+
+	// the file is closed after the reader has joined its I/O thread
+	return {};
+}
+
+// definition for the validation checks that need the whole mesh (parallel)
+void AneuMeshLoader::validate(size_t nodesInFile, const ValidationBlock& finite, const ValidationBlock& boundary) {
+	ThreadPool& pool = ThreadPool::shared();
+	size_t chunks = pool.size();
+	std::vector<std::vector<ValidationIssue>> found(chunks);
+
+	// the passes mark and count through relaxed atomics, the lists they fill are sorted
+	// or only searched afterwards, so the timing of the threads doesn't show in the report
+	constexpr std::memory_order relaxed = std::memory_order_relaxed;
+
+	// filtered finite elements leave nodes and boundary faces without a finite element
+	bool allFinite = !_loadOptions._skipFiniteElements && _loadOptions._materialIds.empty();
+
+	// positions of the nodes of the file, nodesInFile for undefined ones
+	size_t missing = nodesInFile;
+	const std::vector<size_t>& finiteNodes = finite._nodes;
+	const std::vector<size_t>& boundaryNodes = boundary._nodes;
+	auto first = [](const ValidationBlock& block, size_t e) { return e == 0 ? 0 : block._offsets[e - 1]; };
+
+	auto mark = [&](std::vector<std::atomic<char>>& marks, const std::vector<size_t>& nodes) {
+		pool.parallelFor(nodes.size(), chunks, [&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) marks[nodes[i]].store(1, relaxed);
+		});
+	};
+
+	// offsets of lists from their sizes, the sizes count down to 0 again while the lists are filled
+	auto prefixSum = [](const std::vector<std::atomic<size_t>>& sizes) {
+		std::vector<size_t> offsets(sizes.size() + 1, 0);
+		for (size_t k = 0; k < sizes.size(); ++k) offsets[k + 1] = offsets[k] + sizes[k].load(relaxed);
+		return offsets;
+	};
+
+	// boundary node -> finite elements incidence (only the nodes of boundary elements are needed)
+	std::vector<size_t> incidenceOffsets(missing + 1, 0), incidence;
+	if (allFinite && !boundary._ids.empty()) {
+		std::vector<std::atomic<char>> onBoundary(missing + 1);
+		mark(onBoundary, boundaryNodes);
+
+		std::vector<std::atomic<size_t>> degree(missing);
+		pool.parallelFor(finiteNodes.size(), chunks, [&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				if (size_t k = finiteNodes[i]; k < missing && onBoundary[k].load(relaxed)) degree[k].fetch_add(1, relaxed);
+		});
+		incidenceOffsets = prefixSum(degree);
+
+		incidence.resize(incidenceOffsets.back());
+		pool.parallelFor(finite._ids.size(), chunks, [&](size_t, size_t begin, size_t end) {
+			for (size_t e = begin; e < end; ++e)
+				for (size_t i = first(finite, e); i < finite._offsets[e]; ++i)
+					if (size_t k = finiteNodes[i]; k < missing && onBoundary[k].load(relaxed))
+						incidence[incidenceOffsets[k] + degree[k].fetch_sub(1, relaxed) - 1] = e;
+		});
+	}
+
+	// repeated nodes, boundary faces and duplicates, the sorted nodes of every element are kept
+	// (same offsets as the block) with a hash key of them for the duplicate search
+	auto checkBlock = [&](const ValidationBlock& block, const std::vector<size_t>& blockNodes, size_t headerLines, bool faces) {
+		size_t count = block._ids.size();
+		std::vector<size_t> sorted(blockNodes.size());
+		std::vector<uint64_t> keys(count);
+		auto nodesOf = [&](size_t e) { return std::span<const size_t>(sorted).subspan(first(block, e), block._offsets[e] - first(block, e)); };
+
+		pool.parallelFor(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+			for (size_t e = begin; e < end; ++e) {
+				size_t id = block._ids[e];
+				std::span<size_t> nodes(sorted.data() + first(block, e), block._offsets[e] - first(block, e));
+				std::copy(blockNodes.begin() + first(block, e), blockNodes.begin() + block._offsets[e], nodes.begin());
+				// insertion sort, elements have a few nodes
+				for (size_t i = 1; i < nodes.size(); ++i)
+					for (size_t j = i; j > 0 && nodes[j] < nodes[j - 1]; --j) std::swap(nodes[j], nodes[j - 1]);
+
+				// undefined nodes are reported while parsing
+				if (std::ranges::adjacent_find(nodes, [missing](size_t a, size_t b) { return a == b && a != missing; }) != nodes.end())
+					found[chunk].push_back({ ValidationCheck::Degenerate, nodesInFile + headerLines + id, id,
+								 "a node is used more than once" });
+
+				uint64_t key = 0xcbf29ce484222325ull;
+				for (const size_t& k : nodes) key = (key ^ k) * 0x100000001b3ull;
+				keys[e] = key;
+
+				if (!faces || nodes.empty() || nodes.back() == missing) continue;
+
+				// the finite elements of the boundary node used by the fewest of them are searched
+				size_t k = *std::ranges::min_element(nodes, {}, [&](size_t p) { return incidenceOffsets[p + 1] - incidenceOffsets[p]; });
+				bool face = false;
+				for (size_t i = incidenceOffsets[k]; i < incidenceOffsets[k + 1] && !face; ++i) {
+					auto owner = std::span(finiteNodes).subspan(first(finite, incidence[i]), finite._offsets[incidence[i]] - first(finite, incidence[i]));
+					face = std::ranges::all_of(nodes, [&owner](size_t p) { return std::ranges::find(owner, p) != owner.end(); });
+				}
+				if (!face)
+					found[chunk].push_back({ ValidationCheck::BoundaryFace, nodesInFile + headerLines + id, id,
+								 "not a face of any finite element" });
+			}
+		});
+
+		// elements grouped into buckets by their smallest node (a parallel counting sort),
+		// duplicates have the same smallest node, so only elements of one bucket are compared
+		auto smallest = [&](size_t e) { return first(block, e) == block._offsets[e] ? missing : sorted[first(block, e)]; };
+		std::vector<std::atomic<size_t>> sizes(missing + 1);
+		pool.parallelFor(count, chunks, [&](size_t, size_t begin, size_t end) {
+			for (size_t e = begin; e < end; ++e) sizes[smallest(e)].fetch_add(1, relaxed);
+		});
+		std::vector<size_t> offsets = prefixSum(sizes);
+
+		std::vector<size_t> grouped(count);
+		pool.parallelFor(count, chunks, [&](size_t, size_t begin, size_t end) {
+			for (size_t e = begin; e < end; ++e) {
+				size_t bucket = smallest(e);
+				grouped[offsets[bucket] + sizes[bucket].fetch_sub(1, relaxed) - 1] = e;
+			}
+		});
+
+		// a bucket is ordered by key and id, so the original (the smallest id of equal elements)
+		// is the first equal one of its key
+		pool.parallelFor(missing + 1, chunks, [&](size_t chunk, size_t begin, size_t end) {
+			for (size_t bucket = begin; bucket < end; ++bucket) {
+				std::span<size_t> members(grouped.data() + offsets[bucket], offsets[bucket + 1] - offsets[bucket]);
+				if (members.size() < 2) continue;
+				std::ranges::sort(members, {}, [&](size_t e) { return std::pair{ keys[e], block._ids[e] }; });
+
+				for (size_t a = 1, run = 0; a < members.size(); ++a) {
+					size_t e = members[a];
+					if (keys[e] != keys[members[run]]) {
+						run = a;
+						continue;
+					}
+					for (size_t b = run; b < a; ++b) {
+						size_t other = members[b];
+						if (!std::ranges::equal(nodesOf(e), nodesOf(other))) continue;
+
+						found[chunk].push_back({ ValidationCheck::Duplicate, nodesInFile + headerLines + block._ids[e], block._ids[e],
+									 "same nodes as element " + std::to_string(block._ids[other]) });
+						break;
+					}
+				}
+			}
+		});
+	};
+
+	checkBlock(finite, finiteNodes, 2, false);
+	checkBlock(boundary, boundaryNodes, 3, allFinite);
+
+	if (allFinite) {
+		std::vector<std::atomic<char>> used(missing + 1);
+		mark(used, finiteNodes);
+		mark(used, boundaryNodes);
+		pool.parallelFor(missing, chunks, [&](size_t chunk, size_t begin, size_t end) {
+			for (size_t k = begin; k < end; ++k)
+				if (!used[k].load(relaxed)) found[chunk].push_back({ ValidationCheck::OrphanNode, k + 2, k + 1, "node is not used by any element" });
+		});
+	}
+
+	for (std::vector<ValidationIssue>& issues : found) _validation.merge(std::move(issues));
+}
+
+// definition for adding issues to a validation report
+void ValidationReport::merge(std::vector<ValidationIssue>&& issues) {
+	for (const ValidationIssue& issue : issues) _counts[static_cast<size_t>(issue._check)]++;
+
+	_issues.insert(end(_issues), std::make_move_iterator(begin(issues)), std::make_move_iterator(end(issues)));
+	std::ranges::sort(_issues, [](const ValidationIssue& lhs, const ValidationIssue& rhs) {
+		return std::tie(lhs._line, lhs._check) < std::tie(rhs._line, rhs._check);
+	});
+	if (_issues.size() > _maxIssues) _issues.resize(_maxIssues);
+}
+
+// definition for printing a validation report
+void ValidationReport::print(std::ostream& output) const {
+	static constexpr const char* names[] = { "column count", "arity", "missing node", "degenerate",
+						 "duplicate", "orphan node", "boundary face" };
+
+	size_t total = std::accumulate(begin(_counts), end(_counts), size_t{ 0 });
+	output << "Validation: " << total << " issue(s)\n";
+	for (size_t c = 0; c < _counts.size(); ++c)
+		if (_counts[c]) output << "  " << names[c] << ": " << _counts[c] << '\n';
+
+	for (const ValidationIssue& issue : _issues)
+		output << "line " << issue._line << " (id " << issue._id << "): "
+		       << names[static_cast<size_t>(issue._check)] << ", " << issue._message << '\n';
+	if (_issues.size() < total) output << "... " << total - _issues.size() << " more\n";
 }
 
 // definition for getter Node in a derived class for the files with type *.neu
 std::vector<Node> AneuMeshLoader::getNodes() const {
 	std::vector<Node> res;
+	res.reserve(_nodesMap.size());
 
 	std::ranges::transform(_nodesMap, std::back_inserter(res),
 		[](const auto& el) {
@@ -126,6 +555,7 @@ std::vector<Node> AneuMeshLoader::getNodes() const {
 // definition for getter Finite Element in a derived class for the files with type *.neu
 std::vector<FiniteElement> AneuMeshLoader::getFiniteElements() const {
 	std::vector<FiniteElement> res;
+	res.reserve(_finiteElementsSet.size());
 	std::ranges::copy(_finiteElementsSet, std::back_inserter(res));
 	std::ranges::sort(res, {}, &FiniteElement::_id);
 	return res;
@@ -134,6 +564,7 @@ std::vector<FiniteElement> AneuMeshLoader::getFiniteElements() const {
 // definition for getter Surface Finite element in a derived class for the files with type* .neu
 std::vector<BoundaryElement> AneuMeshLoader::getBoundaryElements() const {
 	std::vector<BoundaryElement> res;
+	res.reserve(_boundaryElementsSet.size());
 	std::ranges::copy(_boundaryElementsSet, std::back_inserter(res));
 	std::ranges::sort(res, {}, &BoundaryElement::_id);
 	return res;
@@ -143,17 +574,28 @@ std::vector<BoundaryElement> AneuMeshLoader::getBoundaryElements() const {
 std::vector<FiniteElement> AneuMeshLoader::findFiniteElementsByVertices(size_t node1id, 
 									size_t node2id, 
 									size_t node3id) {
-	if (!(_nodesMap.contains(node1id) && 
-	      _nodesMap.contains(node2id) && 
-	      _nodesMap.contains(node3id)))
-		throw Exception("One or more nodes are not present in the loaded data");
+	return tryFindFiniteElementsByVertices(node1id, node2id, node3id).value();
+}
 
-	Node& node1 = _nodesMap[node1id];
-	Node& node2 = _nodesMap[node2id];
-	Node& node3 = _nodesMap[node3id];
+// definition for method for finding Finite Elements by 2 Node ids
+std::vector<FiniteElement> AneuMeshLoader::findFiniteElementsByEdges(size_t node1id, 
+								     size_t node2id) {
+	return tryFindFiniteElementsByEdges(node1id, node2id).value();
+}
 
-	if (!(node1._is_vertex && node2._is_vertex && node3._is_vertex)) 
-		throw Exception("Not all nodes are vertices");
+// definition for findFiniteElementsByVertices without exceptions
+Expected<std::vector<FiniteElement>> AneuMeshLoader::tryFindFiniteElementsByVertices(size_t node1id, 
+										      size_t node2id, 
+										      size_t node3id) const {
+	auto node1 = _nodesMap.find(node1id);
+	auto node2 = _nodesMap.find(node2id);
+	auto node3 = _nodesMap.find(node3id);
+
+	if (node1 == end(_nodesMap) || node2 == end(_nodesMap) || node3 == end(_nodesMap))
+		return MeshError{ ErrorCode::MissingNode, 0, 0, "One or more nodes are not present in the loaded data" };
+
+	if (!(node1->second._is_vertex && node2->second._is_vertex && node3->second._is_vertex)) 
+		return MeshError{ ErrorCode::NotVertex, 0, 0, "Not all nodes are vertices" };
 
 	std::vector<FiniteElement> res{};
 
@@ -169,15 +611,13 @@ std::vector<FiniteElement> AneuMeshLoader::findFiniteElementsByVertices(size_t n
 	return res;
 }
 
-// definition for method for finding Finite Elements by 2 Node ids
-std::vector<FiniteElement> AneuMeshLoader::findFiniteElementsByEdges(size_t node1id, 
-								     size_t node2id) {
+// definition for findFiniteElementsByEdges without exceptions
+Expected<std::vector<FiniteElement>> AneuMeshLoader::tryFindFiniteElementsByEdges(size_t node1id, 
+										   size_t node2id) const {
 	if (!(_nodesMap.contains(node1id) && 
 		  _nodesMap.contains(node2id))) 
-		throw Exception("One or more nodes are not present in the loaded data");
+		return MeshError{ ErrorCode::MissingNode, 0, 0, "One or more nodes are not present in the loaded data" };
 
-	Node& node1 = _nodesMap[node1id];
-	Node& node2 = _nodesMap[node2id];
 	std::vector<FiniteElement> res{};
 
 	std::ranges::copy_if(_finiteElementsSet, std::back_inserter(res),
@@ -220,72 +660,411 @@ std::vector<Node> AneuMeshLoader::findBENodesByAreaID(size_t areaid) {
 	return res;
 }
 
-// definition for method for adding new nodes to the centers of _FE and _SFE
-void AneuMeshLoader::newNodesInEdges() {
-	size_t NodeId = sizeNodes() + 1;
-	bool FE = true, BE = true;
+namespace {
 
-	for (FiniteElement el : _finiteElementsSet) {
-		std::vector<size_t> nodes{};
+// take all elements out of a set, sorted by id
+template <class Element>
+std::vector<Element> takeElements(std::unordered_set<Element, Hash>& set) {
+	std::vector<Element> res;
+	res.reserve(set.size());
+	while (!set.empty()) res.push_back(std::move(set.extract(begin(set)).value()));
+	std::ranges::sort(res, {}, &Element::_id);
+	return res;
+}
 
-		std::ranges::copy(el._nodeIDvec, std::back_inserter(nodes));
+// local edge of an element with n vertices: pairs (0, 1), (0, 2), .. (n - 2, n - 1)
+size_t localEdge(size_t n, size_t i, size_t j) {
+	if (i > j) std::swap(i, j);
+	return i * n - i * (i + 1) / 2 + (j - i - 1);
+}
 
-		std::vector<std::vector<size_t>> combinations{};
-		std::vector<size_t> data(2);
-		size_t n = nodes.size();
-		combinationUtil(combinations, nodes, data, 0, n - 1, 0);
+using Point = std::array<double, 3>;
 
-		for (const std::vector<size_t>& pairOfNodes : combinations) {
-			Node newnode(_spaceDimension);
-			newnode._id = NodeId;
-			std::vector<double>& coords1 = _nodesMap[pairOfNodes[0]]._coords;
-			std::vector<double>& coords2 = _nodesMap[pairOfNodes[1]]._coords;
+Point minus(const Point& a, const Point& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
 
-			for (size_t i = 0; i < _spaceDimension; ++i) {
-				double coord = (coords1[i] + coords2[i]) / 2;
-				newnode._coords[i] = coord;
-			}
+Point cross(const Point& a, const Point& b) {
+	return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
 
-			_nodesMap[NodeId] = newnode;
-			el._nodeIDvec.push_back(NodeId);
+double dot(const Point& a, const Point& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
 
-			NodeId++;
-		}
+// orientation of a simplex: signed measure for full dimension elements,
+// direction/normal for boundary elements (compared by a dot product)
+Point orientation(const std::vector<Point>& p, size_t spaceDim) {
+	if (p.size() == 2) return minus(p[1], p[0]);
+	Point n = cross(minus(p[1], p[0]), minus(p[2], p[0]));
+	if (p.size() == 3) return spaceDim == 2 ? Point{ 0, 0, n[2] } : n;
+	return { dot(n, minus(p[3], p[0])), 0, 0 };
+}
 
-		if (FE) { _amountOfNodesInOneFiniteElement = el._nodeIDvec.size();
-		          FE = false; }
+// vertex of a tetrahedron not touched by any split edge (the split edges then lie on
+// the opposite face), n if there is none
+size_t untouchedVertex(const std::vector<size_t>& mid) {
+	size_t n = 4;
+	for (size_t d = 0; d < n; ++d) {
+		bool touched = false;
+		for (size_t i = 0; i < n; ++i)
+			if (i != d && mid[localEdge(n, i, d)]) touched = true;
+		if (!touched) return d;
 	}
+	return n;
+}
 
-	for (BoundaryElement el : _boundaryElementsSet) {
-		std::vector<size_t> nodes{};
+// true if a simplex with these split edges can be divided without splitting more edges:
+// triangles always, tetrahedra with 0, 1 or 6 split edges or with the split edges on one face
+bool conforming(const std::vector<size_t>& mid) {
+	if (mid.size() != 6) return true;
+	size_t split = static_cast<size_t>(std::ranges::count_if(mid, [](size_t id) { return id != 0; }));
+	return split <= 1 || split == 6 || untouchedVertex(mid) != 4;
+}
+
+// children of a simplex with some of its edges split,
+// mid[localEdge] is the midside node id (0 if the edge is not split)
+// (every face is divided the same way from both sides: bisected with one split edge,
+// cut from the smaller id vertex of the whole edge with two, red refined with three)
+std::vector<std::vector<size_t>> splitSimplex(const std::vector<size_t>& v, const std::vector<size_t>& mid) {
+	size_t n = v.size();
+	size_t split = static_cast<size_t>(std::ranges::count_if(mid, [](size_t id) { return id != 0; }));
+	auto m = [&](size_t i, size_t j) { return mid[localEdge(n, i, j)]; };
+
+	if (split == 0) return { v };
+
+	if (split == 1) {
+		// bisection at the split edge (a, b)
+		size_t edge = static_cast<size_t>(std::ranges::find_if(mid, [](size_t id) { return id != 0; }) - begin(mid));
+		size_t a = 0, b = 1;
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = i + 1; j < n; ++j)
+				if (localEdge(n, i, j) == edge) { a = i; b = j; }
+		std::vector<size_t> first = v, second = v;
+		first[b] = mid[edge];
+		second[a] = mid[edge];
+		return { first, second };
+	}
 
-		std::ranges::copy(el._nodeIDvec, std::back_inserter(nodes));
+	if (n == 3 && split == 2) {
+		// the edge (a, b) is not split, c is the opposite vertex
+		size_t a = 0, b = 1, c = 2;
+		if (!m(0, 2)) { b = 2; c = 1; }
+		else if (!m(1, 2)) { a = 1; b = 2; c = 0; }
+		if (v[b] < v[a]) std::swap(a, b);
+		return { { m(a, c), m(b, c), v[c] }, { v[a], v[b], m(b, c) }, { v[a], m(b, c), m(a, c) } };
+	}
 
-		std::vector<std::vector<size_t>> combinations{};
-		std::vector<size_t> data(2);
-		size_t n = nodes.size();
-		combinationUtil(combinations, nodes, data, 0, n - 1, 0);
+	if (n == 3)
+		return { { v[0], m(0, 1), m(0, 2) }, { m(0, 1), v[1], m(1, 2) },
+			 { m(0, 2), m(1, 2), v[2] }, { m(0, 1), m(1, 2), m(0, 2) } };
+
+	if (split < 6) {
+		// split edges on the face opposite to d: the face is divided like a triangle
+		// and every part is joined with d
+		size_t d = untouchedVertex(mid);
+		std::vector<size_t> face, faceMid;
+		for (size_t i = 0; i < n; ++i)
+			if (i != d) face.push_back(v[i]);
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = i + 1; j < n; ++j)
+				if (i != d && j != d) faceMid.push_back(m(i, j));
+
+		std::vector<std::vector<size_t>> res = splitSimplex(face, faceMid);
+		for (std::vector<size_t>& child : res) child.insert(begin(child) + static_cast<std::ptrdiff_t>(d), v[d]);
+		return res;
+	}
 
-		for (const std::vector<size_t>& pairOfNodes : combinations) {
-			Node newnode(_spaceDimension);
-			newnode._id = NodeId;
-			std::vector<double>& coords1 = _nodesMap[pairOfNodes[0]]._coords;
-			std::vector<double>& coords2 = _nodesMap[pairOfNodes[1]]._coords;
+	// red refinement of a tetrahedron: 4 corners and the inner octahedron cut along (m02, m13)
+	return { { v[0], m(0, 1), m(0, 2), m(0, 3) }, { m(0, 1), v[1], m(1, 2), m(1, 3) },
+		 { m(0, 2), m(1, 2), v[2], m(2, 3) }, { m(0, 3), m(1, 3), m(2, 3), v[3] },
+		 { m(0, 1), m(0, 2), m(0, 3), m(1, 3) }, { m(0, 1), m(0, 2), m(1, 2), m(1, 3) },
+		 { m(0, 2), m(0, 3), m(1, 3), m(2, 3) }, { m(0, 2), m(1, 2), m(1, 3), m(2, 3) } };
+}
+
+} // namespace
+
+// definition for edge table lookup
+size_t AneuMeshLoader::EdgeTable::index(size_t node1id, size_t node2id) const {
+	std::pair<size_t, size_t> key = std::minmax(node1id, node2id);
+	auto it = std::ranges::lower_bound(_edges, key);
+	return static_cast<size_t>(it - begin(_edges));
+}
+
+// definition for method for building the edge table over all node pairs of every element
+AneuMeshLoader::EdgeTable AneuMeshLoader::buildEdgeTable(const std::vector<FiniteElement>&   finite, 
+							 const std::vector<BoundaryElement>& boundary) const {
+	// first edge of every element in the table before deduplication
+	std::vector<size_t> offsets(finite.size() + boundary.size() + 1, 0);
+	for (size_t i = 0; i < finite.size(); ++i) {
+		size_t n = finite[i]._nodeIDvec.size();
+		offsets[i + 1] = offsets[i] + n * (n - 1) / 2;
+	}
+	for (size_t i = 0; i < boundary.size(); ++i) {
+		size_t n = boundary[i]._nodeIDvec.size();
+		offsets[finite.size() + i + 1] = offsets[finite.size() + i] + n * (n - 1) / 2;
+	}
 
-			for (size_t i = 0; i < _spaceDimension; ++i) {
-				double coord = (coords1[i] + coords2[i]) / 2;
-				newnode._coords[i] = coord;
+	EdgeTable res{};
+	res._edges.resize(offsets.back());
+	ThreadPool::shared().parallelFor(offsets.size() - 1, 0, [&](size_t, size_t begin, size_t end) {
+		for (size_t e = begin; e < end; ++e) {
+			const std::vector<size_t>& v = e < finite.size() ? finite[e]._nodeIDvec : boundary[e - finite.size()]._nodeIDvec;
+			size_t at = offsets[e];
+			for (size_t i = 0; i < v.size(); ++i)
+				for (size_t j = i + 1; j < v.size(); ++j) res._edges[at++] = std::minmax(v[i], v[j]);
+		}
+	});
+
+	std::ranges::sort(res._edges);
+	res._edges.erase(std::unique(begin(res._edges), end(res._edges)), end(res._edges));
+	return res;
+}
+
+// definition for method for adding a node in the middle of the split edges
+std::vector<size_t> AneuMeshLoader::addMidsideNodes(const EdgeTable& table, const std::vector<char>* split, bool vertex) {
+	// first free id (ids may have gaps after partial loading)
+	size_t NodeId = 1;
+	for (const auto& [id, node] : _nodesMap) NodeId = std::max(NodeId, id + 1);
+
+	std::vector<size_t> res(table._edges.size(), 0);
+	size_t added = 0;
+	for (size_t i = 0; i < res.size(); ++i)
+		if (!split || (*split)[i]) res[i] = NodeId + added++;
+
+	// coordinates are computed in parallel, the map is filled afterwards
+	std::vector<Node> nodes(res.size());
+	ThreadPool::shared().parallelFor(res.size(), 0, [&](size_t, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			if (!res[i]) continue;
+			Node newnode(_spaceDimension);
+			newnode._id = res[i];
+			newnode._is_vertex = vertex;
+			const std::vector<double>& coords1 = _nodesMap.at(table._edges[i].first)._coords;
+			const std::vector<double>& coords2 = _nodesMap.at(table._edges[i].second)._coords;
+
+			for (size_t k = 0; k < _spaceDimension; ++k) {
+				double coord = (coords1[k] + coords2[k]) / 2;
+				newnode._coords[k] = coord;
 			}
+			nodes[i] = std::move(newnode);
+		}
+	});
+
+	_nodesMap.reserve(_nodesMap.size() + added);
+	for (size_t i = 0; i < res.size(); ++i)
+		if (res[i]) _nodesMap.insert_or_assign(res[i], std::move(nodes[i]));
+	return res;
+}
+
+// definition for method for adding new nodes to the centers of _FE and _SFE
+void AneuMeshLoader::newNodesInEdges() {
+	// elements are taken out of the sets, extended and put back
+	std::vector<FiniteElement> finite = takeElements(_finiteElementsSet);
+	std::vector<BoundaryElement> boundary = takeElements(_boundaryElementsSet);
+
+	// midside node of every edge, shared by all elements with this edge
+	EdgeTable table = buildEdgeTable(finite, boundary);
+	std::vector<size_t> midside = addMidsideNodes(table, nullptr, false);
+
+	auto extend = [&]<class Element>(std::vector<Element>& elements, std::unordered_set<Element, Hash>& set, size_t& amount) {
+		for (Element& el : elements) {
+			size_t n = el._nodeIDvec.size();
+			for (size_t i = 0; i < n; ++i)
+				for (size_t j = i + 1; j < n; ++j)
+					el._nodeIDvec.push_back(midside[table.index(el._nodeIDvec[i], el._nodeIDvec[j])]);
+		}
+
+		if (!elements.empty()) amount = elements.front()._nodeIDvec.size();
+		for (Element& el : elements) set.insert(std::move(el));
+	};
+
+	extend(finite, _finiteElementsSet, _amountOfNodesInOneFiniteElement);
+	extend(boundary, _boundaryElementsSet, _amountOfNodesInOneBoundaryElement);
+}
+
+// definition for method for uniform refinement
+void AneuMeshLoader::refineUniform(size_t levels) {
+	for (size_t level = 0; level < levels; ++level) refine(nullptr);
+}
 
-			_nodesMap[NodeId] = newnode;
-			el._nodeIDvec.push_back(NodeId);
+// definition for method for adaptive refinement
+void AneuMeshLoader::refineMarked(const std::unordered_set<size_t>& ids) {
+	refine(&ids);
+}
 
-			NodeId++;
+// definition for the shared part of the refinement methods
+void AneuMeshLoader::refine(const std::unordered_set<size_t>* marked) {
+	size_t vertices = _spaceDimension + 1;
+	for (const FiniteElement& el : _finiteElementsSet)
+		if (el._nodeIDvec.size() != vertices)
+			throw Exception("Refinement supports linear triangles and tetrahedra only (element " + std::to_string(el._id) + ")");
+	for (const BoundaryElement& el : _boundaryElementsSet)
+		if (el._nodeIDvec.size() != vertices - 1)
+			throw Exception("Refinement supports linear boundary elements only (element " + std::to_string(el._id) + ")");
+
+	std::vector<FiniteElement> finite = takeElements(_finiteElementsSet);
+	std::vector<BoundaryElement> boundary = takeElements(_boundaryElementsSet);
+	EdgeTable table = buildEdgeTable(finite, boundary);
+	ThreadPool& pool = ThreadPool::shared();
+
+	// table index of every local edge of the finite elements
+	size_t edges = vertices * (vertices - 1) / 2;
+	std::vector<size_t> elementEdges(finite.size() * edges);
+	pool.parallelFor(finite.size(), 0, [&](size_t, size_t begin, size_t end) {
+		for (size_t e = begin; e < end; ++e) {
+			const std::vector<size_t>& v = finite[e]._nodeIDvec;
+			for (size_t i = 0; i < vertices; ++i)
+				for (size_t j = i + 1; j < vertices; ++j) elementEdges[e * edges + localEdge(vertices, i, j)] = table.index(v[i], v[j]);
+		}
+	});
+
+	std::vector<char> split(table._edges.size(), marked ? 0 : 1);
+	if (marked) {
+		for (size_t e = 0; e < finite.size(); ++e)
+			if (marked->contains(finite[e]._id))
+				for (size_t k = 0; k < edges; ++k) split[elementEdges[e * edges + k]] = 1;
+
+		// closure: a tetrahedron whose split edges don't fit one of the patterns of splitSimplex
+		// is refined completely, which splits its other edges and may involve its neighbours
+		std::vector<char> upgrade(finite.size());
+		for (bool changed = true; changed;) {
+			pool.parallelFor(finite.size(), 0, [&](size_t, size_t begin, size_t end) {
+				std::vector<size_t> mid(edges);
+				for (size_t e = begin; e < end; ++e) {
+					for (size_t k = 0; k < edges; ++k) mid[k] = split[elementEdges[e * edges + k]];
+					upgrade[e] = !conforming(mid);
+				}
+			});
+
+			changed = false;
+			for (size_t e = 0; e < finite.size(); ++e)
+				if (upgrade[e]) {
+					for (size_t k = 0; k < edges; ++k) split[elementEdges[e * edges + k]] = 1;
+					changed = true;
+				}
+		}
+	}
+
+	std::vector<size_t> midside = addMidsideNodes(table, &split, true);
+
+	// children of every element (orientation of the parent is kept)
+	auto point = [this](size_t id) {
+		Point res{};
+		const std::vector<double>& coords = _nodesMap.at(id)._coords;
+		std::copy_n(begin(coords), std::min<size_t>(coords.size(), 3), begin(res));
+		return res;
+	};
+	auto points = [&point](const std::vector<size_t>& ids) {
+		std::vector<Point> res;
+		for (const size_t& id : ids) res.push_back(point(id));
+		return res;
+	};
+	auto children = [&](const std::vector<size_t>& v) {
+		size_t n = v.size();
+		std::vector<size_t> mid(n * (n - 1) / 2);
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = i + 1; j < n; ++j) mid[localEdge(n, i, j)] = midside[table.index(v[i], v[j])];
+
+		std::vector<std::vector<size_t>> res = splitSimplex(v, mid);
+		if (res.size() > 1) {
+			Point parent = orientation(points(v), _spaceDimension);
+			for (std::vector<size_t>& child : res)
+				if (dot(orientation(points(child), _spaceDimension), parent) < 0) std::swap(child[0], child[1]);
 		}
+		return res;
+	};
+
+	// amount of children is known from the split edges, so the output is allocated up front
+	auto childCount = [&](const std::vector<size_t>& v) {
+		size_t n = v.size(), count = 0;
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = i + 1; j < n; ++j) count += split[table.index(v[i], v[j])];
+		return count == 6 ? size_t{ 8 } : count + 1;
+	};
 
-		if (BE) { _amountOfNodesInOneBoundaryElement = el._nodeIDvec.size();
-			  BE = false;
+	auto refineBlock = [&]<class Element>(const std::vector<Element>& parents, size_t firstId, auto setArea) {
+		std::vector<size_t> offsets(parents.size() + 1, 0);
+		pool.parallelFor(parents.size(), 0, [&](size_t, size_t begin, size_t end) {
+			for (size_t e = begin; e < end; ++e) offsets[e + 1] = childCount(parents[e]._nodeIDvec);
+		});
+		std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+
+		std::vector<Element> res(offsets.back());
+		pool.parallelFor(parents.size(), 0, [&](size_t, size_t begin, size_t end) {
+			for (size_t e = begin; e < end; ++e) {
+				std::vector<std::vector<size_t>> parts = children(parents[e]._nodeIDvec);
+				for (size_t k = 0; k < parts.size(); ++k) {
+					Element& child = res[offsets[e] + k];
+					child._id = firstId + offsets[e] + k;
+					setArea(child, parents[e]);
+					child._nodeIDvec = std::move(parts[k]);
+				}
+			}
+		});
+		return res;
+	};
+
+	std::vector<FiniteElement> newFinite = refineBlock(finite, 1,
+		[](FiniteElement& child, const FiniteElement& parent) { child._material_area_id = parent._material_area_id; });
+	std::vector<BoundaryElement> newBoundary = refineBlock(boundary, newFinite.size() + 1,
+		[](BoundaryElement& child, const BoundaryElement& parent) { child._surface_area_id = parent._surface_area_id; });
+
+	_finiteElementsSet.reserve(newFinite.size());
+	for (FiniteElement& el : newFinite) _finiteElementsSet.insert(std::move(el));
+	_boundaryElementsSet.reserve(newBoundary.size());
+	for (BoundaryElement& el : newBoundary) _boundaryElementsSet.insert(std::move(el));
+}
+
+// definition for method for dropping nodes not used by any element
+void AneuMeshLoader::compactNodes() {
+	std::vector<char> used(_nodesMap.size() + 1);
+	std::unordered_set<size_t> usedOther;
+	auto mark = [&](const std::vector<size_t>& ids) {
+		for (const size_t& id : ids) {
+			if (id < used.size()) used[id] = true;
+			else usedOther.insert(id);
 		}
+	};
+	for (const FiniteElement& el : _finiteElementsSet) mark(el._nodeIDvec);
+	for (const BoundaryElement& el : _boundaryElementsSet) mark(el._nodeIDvec);
+
+	Permutation compaction{};
+	for (auto it = begin(_nodesMap); it != end(_nodesMap);) {
+		bool keep = it->first < used.size() ? used[it->first] : usedOther.contains(it->first);
+		if (keep) compaction._newToOld.push_back((it++)->first);
+		else it = _nodesMap.erase(it);
+	}
+	std::ranges::sort(compaction._newToOld);
+	compaction.buildInverse();
+
+	renumber({ compaction, {} });
+	_compaction = std::move(compaction);
+}
+
+// definition for method for renumbering nodes and finite elements
+void AneuMeshLoader::renumber(const Renumbering& renumbering) {
+	auto newId = [](const Permutation& permutation, size_t id) {
+		auto it = permutation._oldToNew.find(id);
+		return it == end(permutation._oldToNew) ? id : it->second;
+	};
+
+	std::unordered_map<size_t, Node> nodesMap;
+	nodesMap.reserve(_nodesMap.size());
+	for (auto& [id, node] : _nodesMap) {
+		node._id = newId(renumbering._nodes, id);
+		nodesMap.emplace(node._id, std::move(node));
+	}
+	_nodesMap = std::move(nodesMap);
+
+	// elements are taken out of the sets, renumbered and put back
+	std::vector<FiniteElement> finite = takeElements(_finiteElementsSet);
+	for (FiniteElement& el : finite) {
+		el._id = newId(renumbering._finiteElements, el._id);
+		for (size_t& id : el._nodeIDvec) id = newId(renumbering._nodes, id);
+		_finiteElementsSet.insert(std::move(el));
+	}
+
+	std::vector<BoundaryElement> boundary = takeElements(_boundaryElementsSet);
+	for (BoundaryElement& el : boundary) {
+		for (size_t& id : el._nodeIDvec) id = newId(renumbering._nodes, id);
+		_boundaryElementsSet.insert(std::move(el));
 	}
 }
 
@@ -311,6 +1090,98 @@ std::unordered_map<size_t, std::unordered_set<Node, Hash>> AneuMeshLoader::findN
 	return res;
 }
 
+// definition for method for building the sparsity pattern of the global matrix
+SparsityPattern AneuMeshLoader::buildSparsityPattern(size_t dofsPerNode, bool upperOnly) const {
+	if (dofsPerNode == 0)
+		throw Exception("Amount of dofs per node must be positive");
+
+	SparsityPattern res{};
+	res._dofsPerNode = dofsPerNode;
+	res._nodeIds.reserve(_nodesMap.size());
+	for (const auto& [id, node] : _nodesMap) res._nodeIds.push_back(id);
+	std::ranges::sort(res._nodeIds);
+
+	const std::vector<size_t>& ids = res._nodeIds;
+	bool dense = ids.empty() || ids.back() == ids.size();
+	auto position = [&ids, dense](size_t id) {
+		if (dense && id >= 1 && id <= ids.size()) return id - 1;
+		auto it = dense ? end(ids) : std::ranges::lower_bound(ids, id);
+		if (it == end(ids) || *it != id)
+			throw Exception("Node " + std::to_string(id) + " is not present in the loaded data");
+		return static_cast<size_t>(it - begin(ids));
+	};
+
+	// node -> finite elements incidence in CSR form
+	std::vector<const FiniteElement*> elements;
+	elements.reserve(_finiteElementsSet.size());
+	for (const FiniteElement& el : _finiteElementsSet) elements.push_back(&el);
+
+	size_t nodes = ids.size();
+	std::vector<size_t> incidenceOffsets(nodes + 1, 0);
+	for (const FiniteElement* el : elements)
+		for (const size_t& id : el->_nodeIDvec) incidenceOffsets[position(id) + 1]++;
+	std::partial_sum(begin(incidenceOffsets), end(incidenceOffsets), begin(incidenceOffsets));
+
+	std::vector<size_t> incidence(incidenceOffsets.back());
+	{
+		std::vector<size_t> fill(begin(incidenceOffsets), end(incidenceOffsets) - 1);
+		for (size_t i = 0; i < elements.size(); ++i)
+			for (const size_t& id : elements[i]->_nodeIDvec) incidence[fill[position(id)]++] = i;
+	}
+
+	// sorted unique neighbour positions of a node (itself included)
+	auto neighbours = [&](size_t node, std::vector<size_t>& dest) {
+		dest.clear();
+		dest.push_back(node);
+		for (size_t k = incidenceOffsets[node]; k < incidenceOffsets[node + 1]; ++k)
+			for (const size_t& id : elements[incidence[k]]->_nodeIDvec) {
+				size_t other = position(id);
+				if (!upperOnly || other >= node) dest.push_back(other);
+			}
+		std::ranges::sort(dest);
+		dest.erase(std::unique(begin(dest), end(dest)), end(dest));
+	};
+
+	// rows are counted first and filled afterwards, so nothing but the output
+	// and the incidence is kept between the passes
+	ThreadPool& pool = ThreadPool::shared();
+	std::vector<size_t> nodeColumns(nodes);
+	pool.parallelFor(nodes, 0, [&](size_t, size_t begin, size_t end) {
+		std::vector<size_t> scratch;
+		for (size_t node = begin; node < end; ++node) {
+			neighbours(node, scratch);
+			nodeColumns[node] = scratch.size();
+		}
+	});
+
+	// the diagonal block of a node keeps only its upper triangle in upperOnly mode
+	size_t d = dofsPerNode;
+	auto rowLength = [d, upperOnly](size_t columns, size_t component) {
+		return upperOnly ? (columns - 1) * d + (d - component) : columns * d;
+	};
+
+	res._rowPtr.assign(nodes * d + 1, 0);
+	for (size_t node = 0; node < nodes; ++node)
+		for (size_t c = 0; c < d; ++c)
+			res._rowPtr[node * d + c + 1] = res._rowPtr[node * d + c] + rowLength(nodeColumns[node], c);
+
+	res._colIdx.resize(res._rowPtr.back());
+	pool.parallelFor(nodes, 0, [&](size_t, size_t begin, size_t end) {
+		std::vector<size_t> scratch;
+		for (size_t node = begin; node < end; ++node) {
+			neighbours(node, scratch);
+			for (size_t c = 0; c < d; ++c) {
+				size_t at = res._rowPtr[node * d + c];
+				for (const size_t& other : scratch)
+					for (size_t b = other == node && upperOnly ? c : 0; b < d; ++b)
+						res._colIdx[at++] = other * d + b;
+			}
+		}
+	});
+
+	return res;
+}
+
 // Derived class *.aneu
 // 
 // definition for NeuToAneu method (turn *.neu file to *.aneu)
@@ -343,7 +1214,7 @@ std::fstream AneuMeshLoader::NeuToAneu(std::fstream&       filename,
 
 		// write to the *.aneu file
 		line = std::to_string(count) + " " + std::to_string(data) + "\r";
-		aneu << line << std::endl;
+		aneu << line << '\n';
 
 		// go back to old position
 		neu.seekg(oldpos);
@@ -351,7 +1222,7 @@ std::fstream AneuMeshLoader::NeuToAneu(std::fstream&       filename,
 		// iterating through the block
 		for (size_t i = 0; i < count; ++i) {
 			std::getline(neu, line);
-			aneu << line << std::endl;
+			aneu << line << '\n';
 		}
 	};
 
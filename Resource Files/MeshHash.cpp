@@ -0,0 +1,232 @@
+#include <bit>
+#include <iomanip>
+#include <sstream>
+
+#include "MeshHash.h"
+
+namespace {
+
+// splitmix64 finalizer
+uint64_t mix(uint64_t x) {
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+// hash of a sequence of words (the order of the words matters)
+class RecordHash {
+public:
+	explicit RecordHash(uint64_t seed) : _state(mix(seed)) {}
+
+	void add(uint64_t word) { _state = mix(_state ^ word) + 0x9e3779b97f4a7c15ull; }
+
+	// -0.0 and 0.0 are the same coordinate
+	void add(double value) { add(std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value)); }
+
+	uint64_t value() const { return mix(_state); }
+private:
+	uint64_t _state;
+};
+
+// the seeds keep equal looking records of different kinds apart
+constexpr uint64_t nodeSeed = 1, finiteSeed = 2, boundarySeed = 3;
+
+uint64_t hashRecord(const Node& node) {
+	RecordHash res(nodeSeed);
+	res.add(static_cast<uint64_t>(node._id));
+	res.add(static_cast<uint64_t>(node._coords.size()));
+	for (const double& coord : node._coords) res.add(coord);
+	return res.value();
+}
+
+uint64_t hashRecord(const FiniteElement& el) {
+	RecordHash res(finiteSeed);
+	res.add(static_cast<uint64_t>(el._id));
+	res.add(static_cast<uint64_t>(el._material_area_id));
+	res.add(static_cast<uint64_t>(el._nodeIDvec.size()));
+	for (const size_t& id : el._nodeIDvec) res.add(static_cast<uint64_t>(id));
+	return res.value();
+}
+
+uint64_t hashRecord(const BoundaryElement& el) {
+	RecordHash res(boundarySeed);
+	res.add(static_cast<uint64_t>(el._id));
+	res.add(static_cast<uint64_t>(el._surface_area_id));
+	res.add(static_cast<uint64_t>(el._nodeIDvec.size()));
+	for (const size_t& id : el._nodeIDvec) res.add(static_cast<uint64_t>(id));
+	return res.value();
+}
+
+const Node& record(const std::pair<const size_t, Node>& el) { return el.second; }
+
+template <class T>
+const T& record(const T& el) { return el; }
+
+// sum of the record hashes of an unordered container, its buckets are split between the workers
+template <class Container>
+uint64_t sumBuckets(const Container& records, ThreadPool& pool) {
+	std::vector<uint64_t> partial(pool.size() * 4);
+	pool.parallelFor(records.bucket_count(), partial.size(), [&](size_t chunk, size_t begin, size_t end) {
+		uint64_t sum = 0;
+		for (size_t bucket = begin; bucket < end; ++bucket)
+			for (auto it = records.begin(bucket); it != records.end(bucket); ++it) sum += hashRecord(record(*it));
+		partial[chunk] = sum;
+	});
+	return std::accumulate(begin(partial), end(partial), uint64_t{ 0 });
+}
+
+// sum of the record hashes of a vector
+template <class T>
+uint64_t sumRange(const std::vector<T>& records, ThreadPool& pool) {
+	std::vector<uint64_t> partial(pool.size() * 4);
+	pool.parallelFor(records.size(), partial.size(), [&](size_t chunk, size_t begin, size_t end) {
+		uint64_t sum = 0;
+		for (size_t i = begin; i < end; ++i) sum += hashRecord(records[i]);
+		partial[chunk] = sum;
+	});
+	return std::accumulate(begin(partial), end(partial), uint64_t{ 0 });
+}
+
+// whole mesh value from the parts
+void finish(MeshDigest& digest, std::initializer_list<size_t> sizes) {
+	for (size_t lane = 0; lane < digest._value.size(); ++lane) {
+		RecordHash res(0x6d657368ull + lane);
+		for (const size_t& size : sizes) res.add(static_cast<uint64_t>(size));
+		res.add(digest._nodes);
+		res.add(digest._finiteElements);
+		res.add(digest._boundaryElements);
+		digest._value[lane] = res.value();
+	}
+}
+
+// pointers to the records of a set sorted by id
+template <class T>
+std::vector<const T*> sortedById(const std::unordered_set<T, Hash>& records) {
+	std::vector<const T*> res;
+	res.reserve(records.size());
+	for (const T& el : records) res.push_back(&el);
+	std::ranges::sort(res, {}, &T::_id);
+	return res;
+}
+
+size_t areaId(const FiniteElement& el) { return el._material_area_id; }
+
+size_t areaId(const BoundaryElement& el) { return el._surface_area_id; }
+
+// merge walk over two id sorted blocks of elements
+template <class T>
+void diffElements(const std::unordered_set<T, Hash>& first,
+		  const std::unordered_set<T, Hash>& second,
+		  std::vector<size_t>& added,
+		  std::vector<size_t>& removed,
+		  std::vector<size_t>& changed) {
+	std::vector<const T*> lhs = sortedById(first), rhs = sortedById(second);
+
+	size_t i = 0, j = 0;
+	while (i < lhs.size() || j < rhs.size()) {
+		if (j == rhs.size() || (i < lhs.size() && lhs[i]->_id < rhs[j]->_id)) removed.push_back(lhs[i++]->_id);
+		else if (i == lhs.size() || rhs[j]->_id < lhs[i]->_id) added.push_back(rhs[j++]->_id);
+		else {
+			if (areaId(*lhs[i]) != areaId(*rhs[j]) || lhs[i]->_nodeIDvec != rhs[j]->_nodeIDvec) changed.push_back(lhs[i]->_id);
+			i++;
+			j++;
+		}
+	}
+}
+
+} // namespace
+
+// 32 hex digits of the whole mesh value
+std::string MeshDigest::hex() const {
+	std::ostringstream res;
+	for (const uint64_t& lane : _value) res << std::hex << std::setw(16) << std::setfill('0') << lane;
+	return res.str();
+}
+
+// content hash of a loaded mesh
+MeshDigest hashMesh(const AneuMeshLoader& mesh, ThreadPool& pool) {
+	MeshDigest res{};
+	res._nodes = sumBuckets(mesh.nodesMap(), pool);
+	res._finiteElements = sumBuckets(mesh.finiteElementsSet(), pool);
+	res._boundaryElements = sumBuckets(mesh.boundaryElementsSet(), pool);
+	finish(res, { mesh.spaceDim(), mesh.sizeNodes(), mesh.sizeFiniteElements(), mesh.sizeBoundaryElements() });
+	return res;
+}
+
+// content hash of a snapshot
+MeshDigest hashMesh(const FrozenMesh& mesh, ThreadPool& pool) {
+	MeshDigest res{};
+	res._nodes = sumRange(mesh.getNodes(), pool);
+	res._finiteElements = sumRange(mesh.getFiniteElements(), pool);
+	res._boundaryElements = sumRange(mesh.getBoundaryElements(), pool);
+	finish(res, { mesh.spaceDim(), mesh.sizeNodes(), mesh.sizeFiniteElements(), mesh.sizeBoundaryElements() });
+	return res;
+}
+
+// true if there are no differences
+bool MeshDiff::empty() const {
+	return _addedNodes.empty() && _removedNodes.empty() && _movedNodes.empty() &&
+	       _addedFiniteElements.empty() && _removedFiniteElements.empty() && _changedFiniteElements.empty() &&
+	       _addedBoundaryElements.empty() && _removedBoundaryElements.empty() && _changedBoundaryElements.empty();
+}
+
+// amounts of every kind of difference
+void MeshDiff::print(std::ostream& output) const {
+	output << "Nodes: +" << _addedNodes.size() << " -" << _removedNodes.size() << " moved " << _movedNodes.size() << '\n';
+	output << "Finite Elements: +" << _addedFiniteElements.size() << " -" << _removedFiniteElements.size()
+	       << " changed " << _changedFiniteElements.size() << '\n';
+	output << "Boundary Elements: +" << _addedBoundaryElements.size() << " -" << _removedBoundaryElements.size()
+	       << " changed " << _changedBoundaryElements.size() << '\n';
+}
+
+// structural diff from the first mesh to the second one
+MeshDiff diffMeshes(const AneuMeshLoader& first, const AneuMeshLoader& second, double tolerance, ThreadPool& pool) {
+	MeshDiff res{};
+
+	// nodes are looked up by id in the other map, both maps are split by buckets
+	auto moved = [tolerance](const Node& lhs, const Node& rhs) {
+		if (lhs._coords.size() != rhs._coords.size()) return true;
+		for (size_t i = 0; i < lhs._coords.size(); ++i)
+			if (!(std::abs(lhs._coords[i] - rhs._coords[i]) <= tolerance)) return true;
+		return false;
+	};
+	auto nodePass = [&pool](const std::unordered_map<size_t, Node>& nodes, auto visit) {
+		size_t chunks = pool.size() * 4;
+		std::vector<std::vector<size_t>> found(chunks);
+		pool.parallelFor(nodes.bucket_count(), chunks, [&](size_t chunk, size_t begin, size_t end) {
+			for (size_t bucket = begin; bucket < end; ++bucket)
+				for (auto it = nodes.begin(bucket); it != nodes.end(bucket); ++it) visit(it->second, found[chunk]);
+		});
+
+		std::vector<size_t> res;
+		for (const std::vector<size_t>& ids : found) res.insert(end(res), begin(ids), end(ids));
+		std::ranges::sort(res);
+		return res;
+	};
+
+	const std::unordered_map<size_t, Node>& lhs = first.nodesMap();
+	const std::unordered_map<size_t, Node>& rhs = second.nodesMap();
+	res._removedNodes = nodePass(lhs, [&rhs](const Node& node, std::vector<size_t>& out) {
+		if (!rhs.contains(node._id)) out.push_back(node._id);
+	});
+	res._movedNodes = nodePass(lhs, [&rhs, &moved](const Node& node, std::vector<size_t>& out) {
+		auto other = rhs.find(node._id);
+		if (other != end(rhs) && moved(node, other->second)) out.push_back(node._id);
+	});
+	res._addedNodes = nodePass(rhs, [&lhs](const Node& node, std::vector<size_t>& out) {
+		if (!lhs.contains(node._id)) out.push_back(node._id);
+	});
+
+	// the two element blocks are compared at the same time
+	pool.parallelFor(2, 2, [&](size_t, size_t begin, size_t end) {
+		for (size_t block = begin; block < end; ++block) {
+			if (block == 0)
+				diffElements(first.finiteElementsSet(), second.finiteElementsSet(),
+					     res._addedFiniteElements, res._removedFiniteElements, res._changedFiniteElements);
+			else
+				diffElements(first.boundaryElementsSet(), second.boundaryElementsSet(),
+					     res._addedBoundaryElements, res._removedBoundaryElements, res._changedBoundaryElements);
+		}
+	});
+	return res;
+}
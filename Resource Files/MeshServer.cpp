@@ -0,0 +1,691 @@
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "Builder.h"
+#include "Incidence.h"
+#include "MeshServer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool endsWith(const std::string& text, std::string_view suffix) {
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// cut the first space separated token off a request
+std::string_view nextToken(std::string_view& rest) {
+	size_t begin = rest.find_first_not_of(' ');
+	if (begin == std::string_view::npos) begin = rest.size();
+	size_t end = std::min(rest.find(' ', begin), rest.size());
+	std::string_view res = rest.substr(begin, end - begin);
+	rest.remove_prefix(end);
+	return res;
+}
+
+// "OK" followed by the ids
+std::string okIds(const std::vector<size_t>& ids) {
+	std::string res = "OK";
+	for (const size_t& id : ids) res += " " + std::to_string(id);
+	return res;
+}
+
+// queries answered from the view of a published image, so the mesh isn't held a second time
+// as a FrozenMesh next to it: nodes and elements are sorted by id in the image, only the
+// node -> finite elements incidence (about the size of the FE node section) is kept beside it
+class ImageQueries {
+public:
+	explicit ImageQueries(const BinaryMeshView& view) :
+		_view(view),
+		_incidence(_view._nodeIds.size(),
+			   _view._finiteElementIds.size(),
+			   [this](size_t id) { return nodeIndex(id); },
+			   [this](size_t e) { return finiteNodes(e); }) {}
+
+	// finite element ids with the nodes a and b
+	std::vector<size_t> edge(size_t a, size_t b) const {
+		return findByNodes({ a, b }, false);
+	}
+
+	// finite element ids with the vertex nodes a, b and c
+	std::vector<size_t> face(size_t a, size_t b, size_t c) const {
+		return findByNodes({ a, b, c }, true);
+	}
+
+	// finite element ids with a material id
+	std::vector<size_t> material(size_t id) const {
+		std::vector<size_t> res;
+		for (size_t e = 0; e < _view._materialIds.size(); ++e)
+			if (_view._materialIds[e] == id) res.push_back(_view._finiteElementIds[e]);
+		return res;
+	}
+
+	// boundary element ids with a surface area id
+	std::vector<size_t> area(size_t id) const {
+		std::vector<size_t> res;
+		for (size_t e = 0; e < _view._surfaceIds.size(); ++e)
+			if (_view._surfaceIds[e] == id) res.push_back(_view._boundaryElementIds[e]);
+		return res;
+	}
+
+	// node ids of the boundary elements with a surface area id
+	std::vector<size_t> areaNodes(size_t id) const {
+		std::vector<size_t> res;
+		for (size_t e = 0; e < _view._surfaceIds.size(); ++e) {
+			if (_view._surfaceIds[e] != id) continue;
+			for (const uint64_t& node : _view._boundaryElementNodes.subspan(e * _view._nodesInBE, _view._nodesInBE))
+				if (nodeIndex(node) != npos) res.push_back(node);
+		}
+		std::ranges::sort(res);
+		res.erase(std::unique(begin(res), end(res)), end(res));
+		return res;
+	}
+
+	// node ids sharing a finite element with a node
+	std::vector<size_t> neighbours(size_t id) const {
+		size_t node = nodeIndex(id);
+		if (node == npos) throw Exception("Node " + std::to_string(id) + " is not present in the loaded data");
+
+		std::vector<size_t> res;
+		for (const size_t& e : _incidence.elementsOf(node))
+			for (const uint64_t& other : finiteNodes(e))
+				if (other != id) res.push_back(other);
+		std::ranges::sort(res);
+		res.erase(std::unique(begin(res), end(res)), end(res));
+		return res;
+	}
+private:
+	static constexpr size_t npos = NodeIncidence::npos;
+
+	// position of a node id (npos if it isn't there)
+	size_t nodeIndex(size_t id) const { return NodeIncidence::position(_view._nodeIds, id); }
+
+	// node ids of the finite element at a position
+	std::span<const uint64_t> finiteNodes(size_t e) const {
+		return _view._finiteElementNodes.subspan(e * _view._nodesInFE, _view._nodesInFE);
+	}
+
+	// ids of the finite elements with all of the node ids, checked like the FrozenMesh queries
+	std::vector<size_t> findByNodes(std::initializer_list<size_t> ids, bool vertices) const {
+		std::vector<size_t> nodes;
+		for (const size_t& id : ids) nodes.push_back(nodeIndex(id));
+		checkQueryNodes(nodes, vertices, [this](size_t index) { return _view._isVertex[index] != 0; }).value();
+
+		std::vector<size_t> res = _incidence.intersect(nodes);
+		for (size_t& e : res) e = _view._finiteElementIds[e];
+		return res;
+	}
+
+	BinaryMeshView _view;
+	NodeIncidence _incidence;
+};
+
+// ids of a response payload
+std::vector<size_t> parseIds(const std::string& payload) {
+	std::vector<size_t> res;
+	std::string_view rest = payload;
+	for (std::string_view token = nextToken(rest); !token.empty(); token = nextToken(rest)) {
+		size_t id{};
+		auto [last, ec] = std::from_chars(token.data(), token.data() + token.size(), id);
+		if (ec != std::errc() || last != token.data() + token.size())
+			throw Exception("Malformed id in the response of the mesh server: " + std::string(token));
+		res.push_back(id);
+	}
+	return res;
+}
+
+// all of the statistics of a loaded mesh as one line of JSON
+std::string statsJson(const AneuMeshLoader& mesh) {
+	std::shared_ptr<StatsBuilder> builder(new StatsBuilder());
+	StatsDirector director;
+	director.set_builder(builder);
+	director.CountAllStatisticsWithQuality(mesh);
+
+	std::ostringstream res;
+	builder->GetStat()->WriteJson(res);
+	std::string json = res.str();
+	while (!json.empty() && (json.back() == '\n' || json.back() == '\r')) json.pop_back();
+	return json;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+std::string systemError(const std::string& what) {
+	return what + ": " + std::strerror(errno);
+}
+
+void closeFd(int& fd) {
+	if (fd >= 0) ::close(fd);
+	fd = -1;
+}
+
+// socket address of a path (Exception if it is too long for sun_path)
+sockaddr_un socketAddress(const std::string& path) {
+	sockaddr_un res{};
+	res.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(res.sun_path))
+		throw Exception("Invalid socket path (at most " + std::to_string(sizeof(res.sun_path) - 1) + " bytes): " + path);
+	std::memcpy(res.sun_path, path.c_str(), path.size() + 1);
+	return res;
+}
+
+// send a whole buffer, false if the peer is gone (no SIGPIPE)
+bool sendAll(int fd, std::string_view data) {
+#ifdef MSG_NOSIGNAL
+	constexpr int flags = MSG_NOSIGNAL;
+#else
+	constexpr int flags = 0;
+#endif
+	while (!data.empty()) {
+		ssize_t sent = ::send(fd, data.data(), data.size(), flags);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) return false;
+		data.remove_prefix(static_cast<size_t>(sent));
+	}
+	return true;
+}
+
+// read up to the next line end, the rest stays in the buffer (false at the end of the stream)
+bool receiveLine(int fd, std::string& buffer, std::string& line) {
+	// a peer that never ends its line is dropped
+	constexpr size_t maxLine = 1 << 20;
+
+	size_t eol;
+	while ((eol = buffer.find('\n')) == std::string::npos) {
+		if (buffer.size() > maxLine) return false;
+		char chunk[4096];
+		ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) return false;
+		buffer.append(chunk, static_cast<size_t>(got));
+	}
+	line.assign(buffer, 0, eol);
+	buffer.erase(0, eol + 1);
+	if (!line.empty() && line.back() == '\r') line.pop_back();
+	return true;
+}
+
+// socket of a connection that doesn't raise SIGPIPE where MSG_NOSIGNAL is missing
+int streamSocket() {
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) throw Exception(systemError("Unable to create a socket"));
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+	int on = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+	return fd;
+}
+
+// shared memory object created and mapped for writing by the server,
+// sealed read-only once the image is written
+class SharedImage {
+public:
+	SharedImage(const std::string& name, size_t size) : _name(name), _size(size) {
+		int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0) throw Exception(systemError("Unable to create shared memory object " + name));
+		if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+			std::string message = systemError("Unable to resize shared memory object " + name);
+			::close(fd);
+			::shm_unlink(name.c_str());
+			throw Exception(message);
+		}
+		void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) {
+			std::string message = systemError("Unable to map shared memory object " + name);
+			::shm_unlink(name.c_str());
+			throw Exception(message);
+		}
+		_data = static_cast<char*>(data);
+	}
+
+	~SharedImage() {
+		::munmap(_data, _size);
+		::shm_unlink(_name.c_str());
+	}
+
+	SharedImage(const SharedImage&) = delete;
+	SharedImage& operator = (const SharedImage&) = delete;
+
+	std::span<char> bytes() { return { _data, _size }; }
+
+	// no more writes, the pages stay shared
+	void seal() { ::mprotect(_data, _size, PROT_READ); }
+
+	const std::string& name() const { return _name; }
+
+	size_t size() const { return _size; }
+private:
+	std::string _name;
+	char* _data = nullptr;
+	size_t _size{};
+};
+
+#endif
+
+} // namespace
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// mesh of one path: the shared image is handed to the clients and answers the queries
+struct MeshServer::Published {
+	std::once_flag _loaded;
+	std::atomic<bool> _ready{ false };
+	std::unique_ptr<SharedImage> _image;
+	std::unique_ptr<ImageQueries> _queries;
+
+	// statistics JSON (empty for a binary cache source)
+	std::string _stats;
+};
+
+// constructor (binds and listens on the socket)
+MeshServer::MeshServer(MeshServerOptions options) : _options(std::move(options)) {
+	sockaddr_un address = socketAddress(_options._socketPath);
+	bool bound = false;
+	try {
+		_listener = streamSocket();
+
+		// a socket file nobody listens on is left over from a server that died
+		struct stat info{};
+		if (::stat(_options._socketPath.c_str(), &info) == 0) {
+			if (!S_ISSOCK(info.st_mode)) throw Exception("Not a socket: " + _options._socketPath);
+			int probe = streamSocket();
+			bool alive = ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+			closeFd(probe);
+			if (alive) throw Exception("A mesh server is already listening on " + _options._socketPath);
+			::unlink(_options._socketPath.c_str());
+		}
+
+		if (::bind(_listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+			throw Exception(systemError("Unable to bind " + _options._socketPath));
+		bound = true;
+		::chmod(_options._socketPath.c_str(), 0600);
+		if (::listen(_listener, SOMAXCONN) != 0)
+			throw Exception(systemError("Unable to listen on " + _options._socketPath));
+		if (::pipe(_wake) != 0) throw Exception(systemError("Unable to create a pipe"));
+	}
+	catch (...) {
+		if (bound) ::unlink(_options._socketPath.c_str());
+		closeFd(_listener);
+		closeFd(_wake[0]);
+		closeFd(_wake[1]);
+		throw;
+	}
+}
+
+// destructor (stops the server, removes the socket and the shared memory objects)
+MeshServer::~MeshServer() {
+	stop();
+	{
+		std::unique_lock lock(_mutex);
+		for (const int& fd : _connections) ::shutdown(fd, SHUT_RDWR);
+		_idle.wait(lock, [this] { return _active == 0; });
+	}
+	closeFd(_listener);
+	::unlink(_options._socketPath.c_str());
+	closeFd(_wake[0]);
+	closeFd(_wake[1]);
+}
+
+// published mesh of a path, loaded by the first caller
+MeshServer::Published& MeshServer::published(const std::string& path) {
+	std::string key = std::filesystem::weakly_canonical(std::filesystem::absolute(path)).string();
+
+	std::shared_ptr<Published> res;
+	{
+		std::lock_guard lock(_mutex);
+		std::shared_ptr<Published>& slot = _meshes[key];
+		if (!slot) slot = std::make_shared<Published>();
+		res = slot;
+	}
+
+	// other requests for the same path wait here, the ones for other paths don't
+	std::call_once(res->_loaded, [&] {
+		std::unique_ptr<SharedImage> image;
+		std::string stats;
+		{
+			// the loaded mesh and its snapshot are only needed to write the image
+			std::unique_ptr<FrozenMesh> mesh;
+			if (endsWith(key, ".bin")) {
+				BinaryMesh file = readBinary(key);
+				mesh = std::make_unique<FrozenMesh>(file._view);
+			}
+			else {
+				std::shared_ptr<GatherDataBuilder> builder;
+				if (isNeuPath(key)) builder.reset(new GatherDataBuilderNeu({}, _options._load));
+				else builder.reset(new GatherDataBuilderAneu({}, _options._load));
+				GatherDataDirector director;
+				director.set_builder(builder);
+				director.GatherData(key);
+
+				std::unique_ptr<AneuMeshLoader> loaded = builder->Release();
+				stats = statsJson(*loaded);
+				mesh = std::make_unique<FrozenMesh>(*loaded);
+			}
+
+			std::string name;
+			{
+				std::lock_guard lock(_mutex);
+				name = _options._sharedPrefix + "-" + std::to_string(::getpid()) + "-" + std::to_string(++_counter);
+			}
+			image = std::make_unique<SharedImage>(name, binaryImageSize(*mesh));
+			writeBinaryImage(*mesh, image->bytes());
+			image->seal();
+		}
+
+		res->_queries = std::make_unique<ImageQueries>(BinaryMeshView::parse(image->bytes().data(), image->size()));
+		res->_image = std::move(image);
+		res->_stats = std::move(stats);
+		res->_ready = true;
+	});
+	return *res;
+}
+
+// accept connections until SHUTDOWN or stop()
+void MeshServer::run() {
+	while (!_stopping) {
+		pollfd events[2] = { { _listener, POLLIN, 0 }, { _wake[0], POLLIN, 0 } };
+		if (::poll(events, 2, -1) < 0) {
+			if (errno == EINTR) continue;
+			throw Exception(systemError("Unable to wait for connections"));
+		}
+		if (events[1].revents) break;
+		if (!(events[0].revents & POLLIN)) continue;
+
+		int fd = ::accept(_listener, nullptr, nullptr);
+		if (fd < 0) continue;
+
+		std::lock_guard lock(_mutex);
+		if (_stopping) {
+			::close(fd);
+			break;
+		}
+		_connections.insert(fd);
+		_active++;
+		std::thread(&MeshServer::serve, this, fd).detach();
+	}
+
+	// open connections are cut, their threads finish the current request
+	std::unique_lock lock(_mutex);
+	for (const int& fd : _connections) ::shutdown(fd, SHUT_RDWR);
+	_idle.wait(lock, [this] { return _active == 0; });
+}
+
+// make run() return
+void MeshServer::stop() {
+	if (_stopping.exchange(true)) return;
+	char wake = 1;
+	while (::write(_wake[1], &wake, 1) < 0 && errno == EINTR) {}
+}
+
+// answer the requests of one connection until it is closed
+void MeshServer::serve(int fd) {
+	{
+		std::string buffer, line;
+		while (!_stopping && receiveLine(fd, buffer, line)) {
+			// the response goes out before the connections are cut
+			if (line == "SHUTDOWN") {
+				sendAll(fd, "OK\n");
+				stop();
+				break;
+			}
+			if (!sendAll(fd, answer(line) + '\n')) break;
+		}
+	}
+
+	// the last use of the server by this detached thread: the destructor may run
+	// as soon as the lock is released, nothing of the server is touched after that
+	std::lock_guard lock(_mutex);
+	_connections.erase(fd);
+	::close(fd);
+	if (--_active == 0) _idle.notify_all();
+}
+
+
+// response to one request line
+std::string MeshServer::answer(const std::string& line) {
+	try {
+		std::string_view rest = line;
+		std::string command(nextToken(rest));
+
+		auto numbers = [&](size_t amount) {
+			std::array<size_t, 3> res{};
+			for (size_t i = 0; i < amount; ++i) {
+				std::string_view token = nextToken(rest);
+				auto [last, ec] = std::from_chars(token.data(), token.data() + token.size(), res[i]);
+				if (token.empty() || ec != std::errc() || last != token.data() + token.size())
+					throw Exception(command + " needs " + std::to_string(amount) + " ids before the mesh path");
+			}
+			return res;
+		};
+		auto mesh = [&]() -> Published& {
+			size_t begin = rest.find_first_not_of(' ');
+			if (begin == std::string_view::npos) throw Exception(command + " needs a mesh path");
+			return published(std::string(rest.substr(begin)));
+		};
+
+		if (command == "ATTACH") {
+			Published& entry = mesh();
+			return "OK " + entry._image->name() + " " + std::to_string(entry._image->size());
+		}
+		if (command == "EDGE") {
+			auto [a, b, unused] = numbers(2);
+			return okIds(mesh()._queries->edge(a, b));
+		}
+		if (command == "FACE") {
+			auto [a, b, c] = numbers(3);
+			return okIds(mesh()._queries->face(a, b, c));
+		}
+		if (command == "MATERIAL") {
+			size_t id = numbers(1)[0];
+			return okIds(mesh()._queries->material(id));
+		}
+		if (command == "AREA") {
+			size_t id = numbers(1)[0];
+			return okIds(mesh()._queries->area(id));
+		}
+		if (command == "AREANODES") {
+			size_t id = numbers(1)[0];
+			return okIds(mesh()._queries->areaNodes(id));
+		}
+		if (command == "NEIGHBOURS") {
+			size_t id = numbers(1)[0];
+			return okIds(mesh()._queries->neighbours(id));
+		}
+		if (command == "STATS") {
+			Published& entry = mesh();
+			if (entry._stats.empty()) throw Exception("Statistics need a *.neu or *.aneu source");
+			return "OK " + entry._stats;
+		}
+		if (command == "LIST") {
+			std::string res = "OK";
+			const char* separator = " ";
+			std::lock_guard lock(_mutex);
+			for (const auto& [path, entry] : _meshes) {
+				if (!entry->_ready) continue;
+				res += separator + entry->_image->name() + " " + path;
+				separator = "\t";
+			}
+			return res;
+		}
+		if (command == "SHUTDOWN") {
+			stop();
+			return "OK";
+		}
+		throw Exception("Unknown request '" + command + "'");
+	}
+	catch (const std::exception& e) {
+		std::string message = e.what();
+		std::ranges::replace(message, '\n', ' ');
+		return "ERR " + message;
+	}
+}
+
+#else
+
+struct MeshServer::Published {};
+
+MeshServer::MeshServer(MeshServerOptions options) : _options(std::move(options)) {
+	throw Exception("The mesh server needs POSIX shared memory and Unix domain sockets");
+}
+
+MeshServer::~MeshServer() = default;
+
+MeshServer::Published& MeshServer::published(const std::string&) {
+	throw Exception("The mesh server needs POSIX shared memory and Unix domain sockets");
+}
+
+void MeshServer::run() {}
+
+void MeshServer::stop() { _stopping = true; }
+
+void MeshServer::serve(int) {}
+
+std::string MeshServer::answer(const std::string&) {
+	return "ERR The mesh server needs POSIX shared memory and Unix domain sockets";
+}
+
+#endif
+
+// load and publish a mesh before the first request asks for it
+std::string MeshServer::preload(const std::string& path) {
+	std::string response = answer("ATTACH " + path);
+	if (response.starts_with("ERR ")) throw Exception(response.substr(4));
+	return response.substr(3, response.find(' ', 3) - 3);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// map the shared memory object of a server read-only
+AttachedMesh::AttachedMesh(const std::string& name, size_t size) : _name(name), _size(size) {
+	int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) throw Exception(systemError("Unable to open shared memory object " + name));
+
+	struct stat info{};
+	if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < size) {
+		::close(fd);
+		throw Exception("Shared memory object " + name + " is smaller than announced");
+	}
+	void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) throw Exception(systemError("Unable to map shared memory object " + name));
+	_data = data;
+
+	try {
+		_view = BinaryMeshView::parse(_data, _size);
+	}
+	catch (...) {
+		::munmap(const_cast<void*>(_data), _size);
+		throw;
+	}
+}
+
+AttachedMesh::~AttachedMesh() {
+	if (_data) ::munmap(const_cast<void*>(_data), _size);
+}
+
+// constructor (connects to the socket)
+MeshClient::MeshClient(const std::string& path) {
+	sockaddr_un address = socketAddress(path);
+	_socket = streamSocket();
+	if (::connect(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+		std::string message = systemError("Unable to connect to the mesh server at " + path);
+		closeFd(_socket);
+		throw Exception(message);
+	}
+}
+
+MeshClient::~MeshClient() {
+	closeFd(_socket);
+}
+
+// send one request line and return the payload of the response
+std::string MeshClient::request(const std::string& line) {
+	if (line.find('\n') != std::string::npos) throw Exception("A request is one line");
+	std::string response;
+	if (!sendAll(_socket, line + '\n') || !receiveLine(_socket, _buffer, response))
+		throw Exception("The mesh server closed the connection");
+
+	if (response.starts_with("ERR")) throw Exception(response.size() > 4 ? response.substr(4) : "Request failed: " + line);
+	if (!response.starts_with("OK")) throw Exception("Malformed response of the mesh server: " + response);
+	return response.size() > 3 ? response.substr(3) : std::string();
+}
+
+#else
+
+AttachedMesh::AttachedMesh(const std::string& name, size_t size) : _name(name), _size(size) {
+	throw Exception("Attaching a mesh needs POSIX shared memory");
+}
+
+AttachedMesh::~AttachedMesh() = default;
+
+MeshClient::MeshClient(const std::string&) {
+	throw Exception("The mesh client needs Unix domain sockets");
+}
+
+MeshClient::~MeshClient() = default;
+
+std::string MeshClient::request(const std::string&) {
+	throw Exception("The mesh client needs Unix domain sockets");
+}
+
+#endif
+
+AttachedMesh::AttachedMesh(AttachedMesh&& other) noexcept :
+	_name(std::move(other._name)), _data(std::exchange(other._data, nullptr)),
+	_size(std::exchange(other._size, 0)), _view(other._view) {}
+
+AttachedMesh& AttachedMesh::operator = (AttachedMesh&& other) noexcept {
+	std::swap(_name, other._name);
+	std::swap(_data, other._data);
+	std::swap(_size, other._size);
+	std::swap(_view, other._view);
+	return *this;
+}
+
+// request with a mesh path, the path is sent absolute
+std::string MeshClient::meshRequest(const std::string& request, const std::string& path) {
+	return this->request(request + " " + std::filesystem::absolute(path).string());
+}
+
+// ask the server for a mesh and map its image read-only
+AttachedMesh MeshClient::attach(const std::string& path) {
+	std::istringstream payload(meshRequest("ATTACH", path));
+	std::string name;
+	size_t size{};
+	if (!(payload >> name >> size)) throw Exception("Malformed ATTACH response of the mesh server");
+	return AttachedMesh(name, size);
+}
+
+// finite element ids with an edge
+std::vector<size_t> MeshClient::findFiniteElementsByEdges(const std::string& path, size_t a, size_t b) {
+	return parseIds(meshRequest("EDGE " + std::to_string(a) + " " + std::to_string(b), path));
+}
+
+// finite element ids with 3 vertices
+std::vector<size_t> MeshClient::findFiniteElementsByVertices(const std::string& path, size_t a, size_t b, size_t c) {
+	return parseIds(meshRequest("FACE " + std::to_string(a) + " " + std::to_string(b) + " " + std::to_string(c), path));
+}
+
+// node ids sharing a finite element with a node
+std::vector<size_t> MeshClient::neighbours(const std::string& path, size_t node) {
+	return parseIds(meshRequest("NEIGHBOURS " + std::to_string(node), path));
+}
+
+// statistics of a mesh as JSON
+std::string MeshClient::stats(const std::string& path) {
+	return meshRequest("STATS", path);
+}
@@ -0,0 +1,248 @@
+#include "Partition.h"
+#include "Faces.h"
+#include "Geometry.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+// split [first, last) of order into count parts starting with part
+void bisect(std::vector<size_t>&       order, 
+	    size_t                     first, 
+	    size_t                     last, 
+	    size_t                     part, 
+	    size_t                     count, 
+	    const std::vector<double>& centroids, 
+	    size_t                     dim, 
+	    std::vector<size_t>&       res) {
+	if (count == 1 || last - first <= 1) {
+		for (size_t i = first; i < last; ++i) res[order[i]] = part;
+		return;
+	}
+
+	// widest extent of the centroids
+	size_t axis = 0;
+	double widest = -1;
+	for (size_t d = 0; d < dim; ++d) {
+		double low = std::numeric_limits<double>::max(), high = std::numeric_limits<double>::lowest();
+		for (size_t i = first; i < last; ++i) {
+			low = std::min(low, centroids[order[i] * dim + d]);
+			high = std::max(high, centroids[order[i] * dim + d]);
+		}
+		if (high - low > widest) { widest = high - low; axis = d; }
+	}
+
+	// cut in proportion to the amount of parts on each side
+	size_t left = count / 2;
+	size_t cut = first + (last - first) * left / count;
+	std::nth_element(begin(order) + first, begin(order) + cut, begin(order) + last,
+		[&centroids, dim, axis](size_t a, size_t b) {
+			return centroids[a * dim + axis] < centroids[b * dim + axis];
+		});
+
+	bisect(order, first, cut, part, left, centroids, dim, res);
+	bisect(order, cut, last, part + left, count - left, centroids, dim, res);
+}
+
+// position of an element id in a vector sorted by id
+template <class Element>
+size_t position(const std::vector<Element>& elements, size_t id) {
+	return static_cast<size_t>(std::ranges::lower_bound(elements, id, {}, &Element::_id) - begin(elements));
+}
+
+} // namespace
+
+// build the dual graph through shared faces
+DualGraph buildDualGraph(const FrozenMesh& mesh, ThreadPool& pool) {
+	const std::vector<FiniteElement>& elements = mesh.getFiniteElements();
+	FaceTopology topology = buildFaceTopology(mesh, pool);
+
+	DualGraph res{};
+	res._offsets.assign(elements.size() + 1, 0);
+
+	std::vector<std::pair<size_t, size_t>> pairs;
+	pairs.reserve(topology._interiorFacePairs.size());
+	for (const auto& [a, b] : topology._interiorFacePairs) {
+		pairs.emplace_back(position(elements, a), position(elements, b));
+		res._offsets[pairs.back().first + 1]++;
+		res._offsets[pairs.back().second + 1]++;
+	}
+	std::partial_sum(begin(res._offsets), end(res._offsets), begin(res._offsets));
+
+	res._adjacency.resize(res._offsets.back());
+	std::vector<size_t> fill(begin(res._offsets), end(res._offsets) - 1);
+	for (const auto& [a, b] : pairs) {
+		res._adjacency[fill[a]++] = b;
+		res._adjacency[fill[b]++] = a;
+	}
+
+	pool.parallelFor(res.size(), pool.size() * 4, [&res](size_t, size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i)
+			std::sort(begin(res._adjacency) + res._offsets[i], begin(res._adjacency) + res._offsets[i + 1]);
+	});
+	return res;
+}
+
+// recursive coordinate bisection of the element centroids
+std::vector<size_t> partitionRCB(const FrozenMesh& mesh, size_t parts, ThreadPool& pool) {
+	if (parts == 0)
+		throw Exception("Amount of parts must be positive");
+
+	ElementGeometry geometry = computeGeometry(mesh, pool);
+	std::vector<size_t> order(mesh.sizeFiniteElements());
+	std::iota(begin(order), end(order), 0);
+
+	std::vector<size_t> res(order.size());
+	bisect(order, 0, order.size(), 0, parts, geometry._centroid, mesh.spaceDim(), res);
+	return res;
+}
+
+// amount of dual graph edges between different parts
+size_t edgeCut(const DualGraph& graph, const std::vector<size_t>& parts) {
+	size_t res = 0;
+	for (size_t i = 0; i < graph.size(); ++i)
+		for (const size_t& j : graph.neighbours(i))
+			if (i < j && parts[i] != parts[j]) res++;
+	return res;
+}
+
+// write <base>.part<k>.aneu and <base>.part<k>.map for every part
+std::vector<PartitionMap> writePartitions(const FrozenMesh&          mesh, 
+					  const std::vector<size_t>& parts, 
+					  size_t                     count, 
+					  const std::string&         base) {
+	const std::vector<FiniteElement>& elements = mesh.getFiniteElements();
+	const std::vector<BoundaryElement>& boundary = mesh.getBoundaryElements();
+
+	if (parts.size() != elements.size())
+		throw Exception("Partition has " + std::to_string(parts.size()) + " entries for " + 
+				std::to_string(elements.size()) + " finite elements");
+	for (size_t i = 0; i < parts.size(); ++i)
+		if (parts[i] >= count)
+			throw Exception("Finite element " + std::to_string(elements[i]._id) + " is assigned to part " + 
+					std::to_string(parts[i]) + " of " + std::to_string(count));
+
+	// a boundary element without an owner would belong to no part and be lost
+	FaceTopology topology = buildFaceTopology(mesh);
+	if (!topology._unmatchedBoundaryElements.empty())
+		throw Exception("Boundary element " + std::to_string(topology._unmatchedBoundaryElements.front()) + 
+				" is not a face of any finite element (" + std::to_string(topology._unmatchedBoundaryElements.size()) + 
+				" unmatched), it can't be given to a part");
+
+	// owner of a node: the smallest part using it
+	std::vector<size_t> owner(mesh.sizeNodes(), count);
+	for (size_t i = 0; i < elements.size(); ++i)
+		for (const size_t& id : elements[i]._nodeIDvec) {
+			size_t index = mesh.nodeIndex(id);
+			if (index != FrozenMesh::npos) owner[index] = std::min(owner[index], parts[i]);
+		}
+
+	std::vector<PartitionMap> res(count);
+	for (size_t p = 0; p < count; ++p) {
+		res[p]._part = p;
+		res[p]._parts = count;
+	}
+
+	for (size_t i = 0; i < elements.size(); ++i) res[parts[i]]._elementGlobal.push_back(elements[i]._id);
+	for (const BoundaryElement& el : boundary)
+		res[parts[position(elements, topology._boundaryOwners.at(el._id)._element)]]._boundaryGlobal.push_back(el._id);
+
+	for (PartitionMap& map : res) {
+		// local nodes in global id order
+		for (const size_t& id : map._elementGlobal)
+			for (const size_t& node : elements[position(elements, id)]._nodeIDvec) map._nodeGlobal.push_back(node);
+		std::ranges::sort(map._nodeGlobal);
+		map._nodeGlobal.erase(std::unique(begin(map._nodeGlobal), end(map._nodeGlobal)), end(map._nodeGlobal));
+
+		std::unordered_map<size_t, size_t> local;
+		for (size_t i = 0; i < map._nodeGlobal.size(); ++i) {
+			local[map._nodeGlobal[i]] = i + 1;
+			size_t index = mesh.nodeIndex(map._nodeGlobal[i]);
+			map._nodeOwner.push_back(index == FrozenMesh::npos ? map._part : owner[index]);
+			if (map._nodeOwner.back() != map._part) map._halo.push_back(i + 1);
+		}
+
+		std::string name = base + ".part" + std::to_string(map._part);
+		std::ofstream aneu(name + ".aneu", std::ios_base::binary | std::ios_base::trunc);
+		if (!aneu.is_open())
+			throw Exception("Unable to create file: " + name + ".aneu");
+		aneu << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+		aneu << map._nodeGlobal.size() << " " << mesh.spaceDim() << "\r\n";
+		for (const size_t& id : map._nodeGlobal) {
+			const Node* node = mesh.findNode(id);
+			if (!node)
+				throw Exception("Node " + std::to_string(id) + " is not present in the loaded data");
+			for (const double& coord : node->_coords) aneu << " " << coord;
+			aneu << "\r\n";
+		}
+
+		auto writeElements = [&aneu, &local](const auto& all, const std::vector<size_t>& ids, auto areaId) {
+			size_t nodes = ids.empty() ? 0 : all[position(all, ids[0])]._nodeIDvec.size();
+			aneu << ids.size() << " " << nodes << "\r\n";
+			for (const size_t& id : ids) {
+				const auto& el = all[position(all, id)];
+				aneu << areaId(el);
+				for (const size_t& node : el._nodeIDvec) aneu << " " << local.at(node);
+				aneu << "\r\n";
+			}
+		};
+		writeElements(elements, map._elementGlobal, [](const FiniteElement& el) { return el._material_area_id; });
+		writeElements(boundary, map._boundaryGlobal, [](const BoundaryElement& el) { return el._surface_area_id; });
+
+		std::ofstream out(name + ".map", std::ios_base::trunc);
+		if (!out.is_open())
+			throw Exception("Unable to create file: " + name + ".map");
+
+		out << "part " << map._part << " " << map._parts << "\n";
+		out << "nodes " << map._nodeGlobal.size() << "\n";
+		for (size_t i = 0; i < map._nodeGlobal.size(); ++i) out << map._nodeGlobal[i] << " " << map._nodeOwner[i] << "\n";
+		out << "elements " << map._elementGlobal.size() << "\n";
+		for (const size_t& id : map._elementGlobal) out << id << "\n";
+		out << "boundary " << map._boundaryGlobal.size() << "\n";
+		for (const size_t& id : map._boundaryGlobal) out << id << "\n";
+		out << "halo " << map._halo.size() << "\n";
+		for (const size_t& id : map._halo) out << id << "\n";
+	}
+
+	return res;
+}
+
+// read a *.map file written by writePartitions
+PartitionMap readPartitionMap(const std::string& path) {
+	std::ifstream in(path);
+	if (!in.is_open())
+		throw Exception("Unable to open file at specified path: " + path);
+
+	PartitionMap res{};
+	std::string tag;
+	size_t amount{};
+
+	auto expect = [&](const char* name) {
+		if (!(in >> tag >> amount) || tag != name)
+			throw Exception("Malformed partition map " + path + ": expected '" + name + "'");
+	};
+	auto readList = [&](std::vector<size_t>& list) {
+		list.resize(amount);
+		for (size_t& id : list)
+			if (!(in >> id)) throw Exception("Malformed partition map " + path);
+	};
+
+	if (!(in >> tag >> res._part >> res._parts) || tag != "part")
+		throw Exception("Malformed partition map " + path + ": expected 'part'");
+
+	expect("nodes");
+	res._nodeGlobal.resize(amount);
+	res._nodeOwner.resize(amount);
+	for (size_t i = 0; i < amount; ++i)
+		if (!(in >> res._nodeGlobal[i] >> res._nodeOwner[i])) throw Exception("Malformed partition map " + path);
+
+	expect("elements");
+	readList(res._elementGlobal);
+	expect("boundary");
+	readList(res._boundaryGlobal);
+	expect("halo");
+	readList(res._halo);
+	return res;
+}
@@ -0,0 +1,107 @@
+#include "Reader.h"
+
+#include <cstring>
+
+// constructor (starts the I/O thread), compressed streams are decompressed on it
+BufferedReader::BufferedReader(std::istream& input, 
+			       const ReaderOptions& options, 
+			       Compression compression) : _source(makeByteSource(input, compression)) {
+	size_t count = options._bufferCount < 2 ? 2 : options._bufferCount;
+	size_t size = options._bufferSize < alignment ? alignment : options._bufferSize;
+	_bufferSize = (size + alignment - 1) / alignment * alignment;
+
+	_buffers.resize(count);
+	for (Buffer& buffer : _buffers)
+		buffer._data.reset(static_cast<char*>(::operator new[](_bufferSize, std::align_val_t{ alignment })));
+
+	_worker = std::thread(&BufferedReader::fill, this);
+}
+
+// destructor (stops and joins the I/O thread)
+BufferedReader::~BufferedReader() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_freedCV.notify_all();
+	if (_worker.joinable()) _worker.join();
+}
+
+// I/O thread body
+void BufferedReader::fill() {
+	try {
+		for (size_t i = 0;; i = (i + 1) % _buffers.size()) {
+			{
+				// backpressure: wait until the parser gives a buffer back
+				std::unique_lock<std::mutex> lock(_mutex);
+				_freedCV.wait(lock, [this] { return _stop || _ready < _buffers.size(); });
+				if (_stop) return;
+			}
+
+			Buffer& buffer = _buffers[i];
+			buffer._size = _source->read(buffer._data.get(), _bufferSize);
+
+			bool last = buffer._size < _bufferSize;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (buffer._size) _ready++;
+				_finished = last;
+			}
+			_filledCV.notify_one();
+			if (last) return;
+		}
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_error = std::current_exception();
+		_finished = true;
+		_filledCV.notify_one();
+	}
+}
+
+// give the current buffer back to the I/O thread
+void BufferedReader::release() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_ready--;
+	}
+	_freedCV.notify_one();
+	_holding = false;
+	_position = 0;
+	_current = (_current + 1) % _buffers.size();
+}
+
+// read one line without the trailing '\n', false if nothing is left
+bool BufferedReader::getline(std::string& line) {
+	line.clear();
+
+	for (;;) {
+		if (!_holding) {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_filledCV.wait(lock, [this] { return _ready > 0 || _finished; });
+			if (_ready == 0) {
+				if (_error) std::rethrow_exception(_error);
+				return !line.empty();
+			}
+			_holding = true;
+		}
+
+		const Buffer& buffer = _buffers[_current];
+		const char* begin = buffer._data.get() + _position;
+		size_t left = buffer._size - _position;
+		const char* end = static_cast<const char*>(std::memchr(begin, '\n', left));
+
+		if (end) {
+			size_t length = static_cast<size_t>(end - begin);
+			line.append(begin, length);
+			_position += length + 1;
+			_consumed += length + 1;
+			if (_position == buffer._size) release();
+			return true;
+		}
+
+		line.append(begin, left);
+		_consumed += left;
+		release();
+	}
+}
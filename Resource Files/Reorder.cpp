@@ -0,0 +1,234 @@
+#include "Reorder.h"
+#include "Mesh.h"
+
+#include <queue>
+#include <cstdint>
+
+namespace {
+
+// node graph over positions in getNodes() (neighbours sorted, without duplicates)
+std::vector<std::vector<size_t>> nodeGraph(const std::vector<Node>&          nodes, 
+					   const std::vector<FiniteElement>& elements) {
+	std::unordered_map<size_t, size_t> position;
+	for (size_t i = 0; i < nodes.size(); ++i) position[nodes[i]._id] = i;
+
+	std::vector<std::vector<size_t>> graph(nodes.size());
+	for (const FiniteElement& el : elements)
+		for (const size_t& i : el._nodeIDvec)
+			for (const size_t& j : el._nodeIDvec)
+				if (i != j && position.contains(i) && position.contains(j))
+					graph[position[i]].push_back(position[j]);
+
+	for (std::vector<size_t>& neighbours : graph) {
+		std::ranges::sort(neighbours);
+		neighbours.erase(std::unique(begin(neighbours), end(neighbours)), end(neighbours));
+	}
+	return graph;
+}
+
+// breadth-first levels from a start node, returns the last level
+std::vector<size_t> lastLevel(const std::vector<std::vector<size_t>>& graph, 
+			      size_t                                  start, 
+			      size_t&                                 depth) {
+	std::vector<size_t> level{ start }, next;
+	std::vector<bool> visited(graph.size());
+	visited[start] = true;
+	depth = 0;
+
+	for (;;) {
+		next.clear();
+		for (const size_t& v : level)
+			for (const size_t& u : graph[v])
+				if (!visited[u]) { visited[u] = true; next.push_back(u); }
+		if (next.empty()) return level;
+		level.swap(next);
+		depth++;
+	}
+}
+
+// reverse Cuthill-McKee order of positions
+std::vector<size_t> reverseCuthillMcKee(const std::vector<std::vector<size_t>>& graph) {
+	size_t n = graph.size();
+	std::vector<size_t> order;
+	std::vector<bool> visited(n);
+	order.reserve(n);
+
+	auto degree = [&graph](size_t v) { return graph[v].size(); };
+
+	while (order.size() < n) {
+		// unvisited node with the smallest degree
+		size_t start = n;
+		for (size_t v = 0; v < n; ++v)
+			if (!visited[v] && (start == n || degree(v) < degree(start))) start = v;
+
+		// move to a pseudo-peripheral node of the component
+		size_t depth{}, nextDepth{};
+		std::vector<size_t> level = lastLevel(graph, start, depth);
+		for (size_t iteration = 0; iteration < 5; ++iteration) {
+			size_t candidate = *std::ranges::min_element(level, {}, degree);
+			std::vector<size_t> candidateLevel = lastLevel(graph, candidate, nextDepth);
+			if (nextDepth <= depth) break;
+			start = candidate;
+			depth = nextDepth;
+			level = std::move(candidateLevel);
+		}
+
+		std::queue<size_t> queue;
+		queue.push(start);
+		visited[start] = true;
+		std::vector<size_t> neighbours;
+
+		while (!queue.empty()) {
+			size_t v = queue.front();
+			queue.pop();
+			order.push_back(v);
+
+			neighbours.clear();
+			for (const size_t& u : graph[v])
+				if (!visited[u]) { visited[u] = true; neighbours.push_back(u); }
+			std::ranges::stable_sort(neighbours, {}, degree);
+			for (const size_t& u : neighbours) queue.push(u);
+		}
+	}
+
+	std::ranges::reverse(order);
+	return order;
+}
+
+// coordinates to transposed Hilbert index (J. Skilling, "Programming the Hilbert curve", 2004)
+void axesToTranspose(uint32_t* x, int bits, int dims) {
+	uint32_t m = 1u << (bits - 1);
+
+	for (uint32_t q = m; q > 1; q >>= 1) {
+		uint32_t p = q - 1;
+		for (int i = 0; i < dims; ++i) {
+			if (x[i] & q) x[0] ^= p;
+			else {
+				uint32_t t = (x[0] ^ x[i]) & p;
+				x[0] ^= t;
+				x[i] ^= t;
+			}
+		}
+	}
+
+	for (int i = 1; i < dims; ++i) x[i] ^= x[i - 1];
+	uint32_t t = 0;
+	for (uint32_t q = m; q > 1; q >>= 1)
+		if (x[dims - 1] & q) t ^= q - 1;
+	for (int i = 0; i < dims; ++i) x[i] ^= t;
+}
+
+// interleave the bits of the coordinates into one key
+uint64_t interleave(const uint32_t* x, int bits, int dims) {
+	uint64_t key = 0;
+	for (int bit = bits - 1; bit >= 0; --bit)
+		for (int i = 0; i < dims; ++i) key = (key << 1) | ((x[i] >> bit) & 1u);
+	return key;
+}
+
+// order of positions along a space-filling curve
+std::vector<size_t> curveOrder(const std::vector<Node>& nodes, bool hilbert) {
+	size_t n = nodes.size();
+	int dims = static_cast<int>(std::min<size_t>(n ? nodes[0]._coords.size() : 0, 3));
+	std::vector<size_t> order(n);
+	std::iota(begin(order), end(order), 0);
+	if (dims == 0) return order;
+
+	// quantize the bounding box to a 2^bits grid
+	int bits = dims == 1 ? 32 : 63 / dims;
+	std::array<double, 3> low{}, high{};
+	for (int d = 0; d < dims; ++d) {
+		auto [minIt, maxIt] = std::ranges::minmax_element(nodes, {}, 
+			[d](const Node& node) { return node._coords[d]; });
+		low[d] = minIt->_coords[d];
+		high[d] = maxIt->_coords[d];
+	}
+
+	double cells = std::ldexp(1.0, bits) - 1;
+	std::vector<uint64_t> keys(n);
+	for (size_t i = 0; i < n; ++i) {
+		uint32_t x[3]{};
+		for (int d = 0; d < dims; ++d) {
+			double extent = high[d] - low[d];
+			double scaled = extent > 0 ? (nodes[i]._coords[d] - low[d]) / extent : 0;
+			x[d] = static_cast<uint32_t>(scaled * cells);
+		}
+		if (hilbert && dims > 1) axesToTranspose(x, bits, dims);
+		keys[i] = interleave(x, bits, dims);
+	}
+
+	std::ranges::stable_sort(order, {}, [&keys](size_t i) { return keys[i]; });
+	return order;
+}
+
+} // namespace
+
+// fill _oldToNew from _newToOld
+void Permutation::buildInverse() {
+	_oldToNew.clear();
+	_oldToNew.reserve(_newToOld.size());
+	for (size_t i = 0; i < _newToOld.size(); ++i) _oldToNew[_newToOld[i]] = i + 1;
+}
+
+// compute renumbering with a strategy
+Renumbering computeRenumbering(const AneuMeshLoader& mesh, ReorderStrategy strategy) {
+	std::vector<Node> nodes = mesh.getNodes();
+	std::vector<FiniteElement> elements = mesh.getFiniteElements();
+
+	std::vector<size_t> order;
+	switch (strategy) {
+	case ReorderStrategy::ReverseCuthillMcKee: { order = reverseCuthillMcKee(nodeGraph(nodes, elements)); break; }
+	case ReorderStrategy::Hilbert: { order = curveOrder(nodes, true); break; }
+	case ReorderStrategy::Morton: { order = curveOrder(nodes, false); break; }
+	default: {
+		order.resize(nodes.size());
+		std::iota(begin(order), end(order), 0);
+		break;
+	}
+	}
+
+	Renumbering res{};
+	for (const size_t& i : order) res._nodes._newToOld.push_back(nodes[i]._id);
+	res._nodes.buildInverse();
+
+	// finite elements follow their smallest new node id
+	auto firstNode = [&res](const FiniteElement& el) {
+		size_t first = std::numeric_limits<size_t>::max();
+		for (const size_t& id : el._nodeIDvec) {
+			auto it = res._nodes._oldToNew.find(id);
+			if (it != end(res._nodes._oldToNew)) first = std::min(first, it->second);
+		}
+		return first;
+	};
+	std::ranges::stable_sort(elements, {}, firstNode);
+
+	for (const FiniteElement& el : elements) res._finiteElements._newToOld.push_back(el._id);
+	res._finiteElements.buildInverse();
+	return res;
+}
+
+// bandwidth of the node graph: max |id1 - id2| over nodes sharing a finite element
+size_t meshBandwidth(const AneuMeshLoader& mesh) {
+	size_t res = 0;
+	for (const FiniteElement& el : mesh.getFiniteElements()) {
+		auto [low, high] = std::ranges::minmax(el._nodeIDvec);
+		res = std::max(res, high - low);
+	}
+	return res;
+}
+
+// profile of the node graph: sum over nodes of the distance to the farthest lower neighbour
+size_t meshProfile(const AneuMeshLoader& mesh) {
+	std::unordered_map<size_t, size_t> lowest;
+	for (const FiniteElement& el : mesh.getFiniteElements()) {
+		size_t low = std::ranges::min(el._nodeIDvec);
+		for (const size_t& id : el._nodeIDvec) {
+			auto [it, inserted] = lowest.try_emplace(id, low);
+			if (!inserted) it->second = std::min(it->second, low);
+		}
+	}
+
+	size_t res = 0;
+	for (const auto& [id, low] : lowest) res += id - low;
+	return res;
+}
@@ -0,0 +1,262 @@
+#include "SpatialIndex.h"
+
+namespace {
+
+// largest amount of elements in a bvh leaf
+constexpr size_t leafSize = 4;
+
+// squared distance between two points
+double distance2(const double* a, const double* b, size_t dim) {
+	double res = 0;
+	for (size_t d = 0; d < dim; ++d) res += (a[d] - b[d]) * (a[d] - b[d]);
+	return res;
+}
+
+// barycentric test of a point against a simplex (dim + 1 vertices)
+bool insideSimplex(const double* v, const double* p, size_t dim, double tolerance) {
+	// solve T * l = p - v0 with T = [v1 - v0, ..., vdim - v0] by Gaussian elimination
+	double a[3][4]{};
+	for (size_t r = 0; r < dim; ++r) {
+		for (size_t c = 0; c < dim; ++c) a[r][c] = v[(c + 1) * dim + r] - v[r];
+		a[r][dim] = p[r] - v[r];
+	}
+
+	for (size_t c = 0; c < dim; ++c) {
+		size_t pivot = c;
+		for (size_t r = c + 1; r < dim; ++r)
+			if (std::abs(a[r][c]) > std::abs(a[pivot][c])) pivot = r;
+		if (std::abs(a[pivot][c]) < 1e-300) return false; // degenerate element
+		std::swap(a[c], a[pivot]);
+
+		for (size_t r = 0; r < dim; ++r) {
+			if (r == c) continue;
+			double factor = a[r][c] / a[c][c];
+			for (size_t k = c; k <= dim; ++k) a[r][k] -= factor * a[c][k];
+		}
+	}
+
+	double sum = 0;
+	for (size_t c = 0; c < dim; ++c) {
+		double l = a[c][dim] / a[c][c];
+		if (l < -tolerance) return false;
+		sum += l;
+	}
+	return sum <= 1 + tolerance;
+}
+
+} // namespace
+
+// constructor (bulk loads both trees, space dimension 1..3)
+SpatialIndex::SpatialIndex(std::shared_ptr<const FrozenMesh> mesh) : _mesh(std::move(mesh)), _dim(_mesh->spaceDim()) {
+	if (_dim == 0 || _dim > 3)
+		throw Exception("Spatial index supports space dimension 1, 2 or 3");
+
+	const std::vector<Node>& nodes = _mesh->getNodes();
+	const std::vector<FiniteElement>& elements = _mesh->getFiniteElements();
+
+	// k-d tree over node positions, median split, axis cycles with depth
+	_kdIds.resize(nodes.size());
+	std::iota(begin(_kdIds), end(_kdIds), 0);
+	buildKd(0, _kdIds.size(), 0);
+
+	_kdCoords.resize(nodes.size() * _dim);
+	for (size_t i = 0; i < _kdIds.size(); ++i) {
+		const Node& node = nodes[_kdIds[i]];
+		std::copy_n(begin(node._coords), _dim, begin(_kdCoords) + i * _dim);
+		_kdIds[i] = node._id;
+	}
+
+	// element boxes and simplex coordinates
+	size_t vertices = _dim + 1;
+	size_t quadratic = vertices + vertices * _dim / 2;
+	_elementBoxes.resize(elements.size());
+	_simplices.resize(elements.size());
+
+	for (size_t i = 0; i < elements.size(); ++i) {
+		Box& box = _elementBoxes[i];
+		box._min.fill(std::numeric_limits<double>::max());
+		box._max.fill(std::numeric_limits<double>::lowest());
+
+		const std::vector<size_t>& ids = elements[i]._nodeIDvec;
+		bool simplex = ids.size() == vertices || ids.size() == quadratic;
+
+		for (size_t k = 0; k < ids.size(); ++k) {
+			const Node* node = _mesh->findNode(ids[k]);
+			if (!node) { simplex = false; continue; }
+			for (size_t d = 0; d < _dim; ++d) {
+				box._min[d] = std::min(box._min[d], node->_coords[d]);
+				box._max[d] = std::max(box._max[d], node->_coords[d]);
+			}
+			if (simplex && k < vertices)
+				_simplices[i].insert(end(_simplices[i]), begin(node->_coords), begin(node->_coords) + _dim);
+		}
+		if (!simplex) _simplices[i].clear();
+	}
+
+	_bvhElements.resize(elements.size());
+	std::iota(begin(_bvhElements), end(_bvhElements), 0);
+	if (!elements.empty()) buildBvh(0, elements.size());
+}
+
+// k-d tree build over [first, last) of _kdIds
+void SpatialIndex::buildKd(size_t first, size_t last, size_t depth) {
+	if (last - first <= 1) return;
+
+	const std::vector<Node>& nodes = _mesh->getNodes();
+	size_t axis = depth % _dim;
+	size_t mid = first + (last - first) / 2;
+
+	std::nth_element(begin(_kdIds) + first, begin(_kdIds) + mid, begin(_kdIds) + last,
+		[&nodes, axis](size_t a, size_t b) {
+			return nodes[a]._coords[axis] < nodes[b]._coords[axis];
+		});
+
+	buildKd(first, mid, depth + 1);
+	buildKd(mid + 1, last, depth + 1);
+}
+
+// k-d tree search over [first, last)
+void SpatialIndex::searchKd(const double*	point, 
+			    size_t		first, 
+			    size_t		last, 
+			    size_t		depth, 
+			    size_t&		best, 
+			    double&		bestDistance) const {
+	if (first >= last) return;
+
+	size_t mid = first + (last - first) / 2;
+	const double* coords = _kdCoords.data() + mid * _dim;
+	double d = distance2(point, coords, _dim);
+	if (d < bestDistance) {
+		bestDistance = d;
+		best = mid;
+	}
+
+	double diff = point[depth % _dim] - coords[depth % _dim];
+	if (diff < 0) {
+		searchKd(point, first, mid, depth + 1, best, bestDistance);
+		if (diff * diff < bestDistance) searchKd(point, mid + 1, last, depth + 1, best, bestDistance);
+	}
+	else {
+		searchKd(point, mid + 1, last, depth + 1, best, bestDistance);
+		if (diff * diff < bestDistance) searchKd(point, first, mid, depth + 1, best, bestDistance);
+	}
+}
+
+// bvh build over [first, last) of _bvhElements, returns node index
+size_t SpatialIndex::buildBvh(size_t first, size_t last) {
+	size_t index = _bvh.size();
+	_bvh.emplace_back();
+
+	Box box{};
+	box._min.fill(std::numeric_limits<double>::max());
+	box._max.fill(std::numeric_limits<double>::lowest());
+	for (size_t i = first; i < last; ++i)
+		for (size_t d = 0; d < _dim; ++d) {
+			box._min[d] = std::min(box._min[d], _elementBoxes[_bvhElements[i]]._min[d]);
+			box._max[d] = std::max(box._max[d], _elementBoxes[_bvhElements[i]]._max[d]);
+		}
+	_bvh[index]._box = box;
+
+	if (last - first <= leafSize) {
+		_bvh[index]._leaf = true;
+		_bvh[index]._left = first;
+		_bvh[index]._right = last - first;
+		return index;
+	}
+
+	// median split of the box centers along the widest axis
+	size_t axis = 0;
+	for (size_t d = 1; d < _dim; ++d)
+		if (box._max[d] - box._min[d] > box._max[axis] - box._min[axis]) axis = d;
+
+	size_t mid = first + (last - first) / 2;
+	std::nth_element(begin(_bvhElements) + first, begin(_bvhElements) + mid, begin(_bvhElements) + last,
+		[this, axis](size_t a, size_t b) {
+			return _elementBoxes[a]._min[axis] + _elementBoxes[a]._max[axis] <
+			       _elementBoxes[b]._min[axis] + _elementBoxes[b]._max[axis];
+		});
+
+	size_t left = buildBvh(first, mid);
+	size_t right = buildBvh(mid, last);
+	_bvh[index]._left = left;
+	_bvh[index]._right = right;
+	return index;
+}
+
+// exact or box containment test of one element
+bool SpatialIndex::contains(size_t element, const double* point, double tolerance) const {
+	if (!_simplices[element].empty())
+		return insideSimplex(_simplices[element].data(), point, _dim, tolerance);
+
+	const Box& box = _elementBoxes[element];
+	for (size_t d = 0; d < _dim; ++d)
+		if (point[d] < box._min[d] - tolerance || point[d] > box._max[d] + tolerance) return false;
+	return true;
+}
+
+// id of the nearest node to a point (0 if the mesh has no nodes)
+size_t SpatialIndex::nearestNode(std::span<const double> point) const {
+	if (point.size() < _dim)
+		throw Exception("Point has less coordinates than the space dimension");
+	if (_kdIds.empty()) return 0;
+
+	size_t best = 0;
+	double bestDistance = std::numeric_limits<double>::max();
+	searchKd(point.data(), 0, _kdIds.size(), 0, best, bestDistance);
+	return _kdIds[best];
+}
+
+// id of a finite element containing a point (0 if the point is outside of the mesh)
+size_t SpatialIndex::locatePoint(std::span<const double> point, double tolerance) const {
+	if (point.size() < _dim)
+		throw Exception("Point has less coordinates than the space dimension");
+	if (_bvh.empty()) return 0;
+
+	// explicit stack, the tree depth is logarithmic
+	size_t stack[128];
+	size_t top = 0;
+	stack[top++] = 0;
+
+	while (top) {
+		const BvhNode& node = _bvh[stack[--top]];
+
+		bool inside = true;
+		for (size_t d = 0; d < _dim && inside; ++d)
+			inside = point[d] >= node._box._min[d] - tolerance && point[d] <= node._box._max[d] + tolerance;
+		if (!inside) continue;
+
+		if (node._leaf) {
+			for (size_t i = node._left; i < node._left + node._right; ++i)
+				if (contains(_bvhElements[i], point.data(), tolerance))
+					return _mesh->getFiniteElements()[_bvhElements[i]]._id;
+			continue;
+		}
+		stack[top++] = node._right;
+		stack[top++] = node._left;
+	}
+	return 0;
+}
+
+// batched nearestNode, points are stored one after another
+void SpatialIndex::nearestNodes(std::span<const double> points, 
+				std::vector<size_t>&    result, 
+				ThreadPool&             pool) const {
+	size_t count = points.size() / _dim;
+	result.resize(count);
+	pool.parallelFor(count, pool.size() * 4, [&](size_t, size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i) result[i] = nearestNode(points.subspan(i * _dim, _dim));
+	});
+}
+
+// batched locatePoint, points are stored one after another
+void SpatialIndex::locatePoints(std::span<const double> points, 
+				std::vector<size_t>&    result, 
+				double                  tolerance, 
+				ThreadPool&             pool) const {
+	size_t count = points.size() / _dim;
+	result.resize(count);
+	pool.parallelFor(count, pool.size() * 4, [&](size_t, size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i) result[i] = locatePoint(points.subspan(i * _dim, _dim), tolerance);
+	});
+}
@@ -0,0 +1,162 @@
+#include "ThreadPool.h"
+
+#include <exception>
+#include <utility>
+
+namespace {
+	// pool and deque index of the current worker thread
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local size_t currentIndex = 0;
+
+	// settings of the shared pool, read once when it is created
+	std::atomic<size_t> sharedThreads{ 0 };
+	std::atomic<bool> sharedCreated{ false };
+}
+
+// constructor (0 threads = hardware concurrency)
+ThreadPool::ThreadPool(size_t threads) {
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	for (size_t i = 0; i < threads; ++i) _queues.push_back(std::make_unique<Queue>());
+	for (size_t i = 0; i < threads; ++i) _workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+// destructor (finishes queued tasks and joins the workers)
+ThreadPool::~ThreadPool() {
+	// a failure nobody waited for is dropped here, destructors don't throw
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_idleCV.wait(lock, [this] { return _pending == 0; });
+		_stop = true;
+	}
+	_wakeCV.notify_all();
+	for (std::thread& worker : _workers) worker.join();
+}
+
+// queue a task (tasks submitted from a worker go to its own deque)
+void ThreadPool::submit(std::function<void()> task) {
+	size_t index = currentPool == this ? currentIndex : _next++ % _queues.size();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_queued++;
+		_pending++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_queues[index]->_mutex);
+		_queues[index]->_tasks.push_back(std::move(task));
+	}
+	_wakeCV.notify_one();
+}
+
+// block until every submitted task has finished, then rethrow the first exception of a task
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_idleCV.wait(lock, [this] { return _pending == 0; });
+	if (_error) std::rethrow_exception(std::exchange(_error, nullptr));
+}
+
+// take a task from own deque (back) or steal from another one (front)
+bool ThreadPool::pop(size_t index, std::function<void()>& task) {
+	for (size_t i = 0; i < _queues.size(); ++i) {
+		Queue& queue = *_queues[(index + i) % _queues.size()];
+		std::lock_guard<std::mutex> lock(queue._mutex);
+		if (queue._tasks.empty()) continue;
+
+		if (i == 0) {
+			task = std::move(queue._tasks.back());
+			queue._tasks.pop_back();
+		}
+		else {
+			task = std::move(queue._tasks.front());
+			queue._tasks.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
+
+// worker body
+void ThreadPool::run(size_t index) {
+	currentPool = this;
+	currentIndex = index;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wakeCV.wait(lock, [this] { return _stop || _queued > 0; });
+			if (_queued == 0) return;
+			_queued--;
+		}
+
+		// a task is reserved for this worker, it is in one of the deques
+		std::function<void()> task;
+		while (!pop(index, task)) std::this_thread::yield();
+		std::exception_ptr error;
+		try {
+			task();
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (error && !_error) _error = error;
+		if (--_pending == 0) _idleCV.notify_all();
+	}
+}
+
+// split [0, count) into chunks and run body(chunk, begin, end) on the workers
+void ThreadPool::parallelFor(size_t count, 
+			     size_t chunks, 
+			     const std::function<void(size_t, size_t, size_t)>& body) {
+	if (count == 0) return;
+	if (chunks == 0) chunks = size();
+	if (chunks > count) chunks = count;
+
+	struct State {
+		std::atomic<size_t> _next{};
+		size_t _done{};
+		std::mutex _mutex;
+		std::condition_variable _doneCV;
+		std::exception_ptr _error;
+	};
+	auto state = std::make_shared<State>();
+
+	// claim chunks until none are left (helpers may start after the caller has returned,
+	// then they find nothing to claim and never touch body)
+	auto work = [state, count, chunks, &body] {
+		for (size_t chunk = state->_next++; chunk < chunks; chunk = state->_next++) {
+			try {
+				body(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(state->_mutex);
+				if (!state->_error) state->_error = std::current_exception();
+			}
+			std::lock_guard<std::mutex> lock(state->_mutex);
+			if (++state->_done == chunks) state->_doneCV.notify_all();
+		}
+	};
+
+	size_t helpers = std::min(size(), chunks - 1);
+	for (size_t i = 0; i < helpers; ++i) submit(work);
+	work();
+
+	std::unique_lock<std::mutex> lock(state->_mutex);
+	state->_doneCV.wait(lock, [&] { return state->_done == chunks; });
+	if (state->_error) std::rethrow_exception(state->_error);
+}
+
+// process-wide pool with hardware concurrency workers (or the amount given to configureShared)
+ThreadPool& ThreadPool::shared() {
+	static ThreadPool pool((sharedCreated = true, sharedThreads.load()));
+	return pool;
+}
+
+// amount of workers of the shared pool, only before its first use
+bool ThreadPool::configureShared(size_t threads) {
+	if (sharedCreated) return false;
+	sharedThreads = threads;
+	return true;
+}
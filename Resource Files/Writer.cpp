@@ -0,0 +1,600 @@
+#include "Writer.h"
+
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <climits>
+#include <cerrno>
+#endif
+
+namespace {
+
+// file opened for writing, buffers are handed over in batches
+// (writev on POSIX systems, large unformatted writes elsewhere)
+class OutputFile {
+public:
+	explicit OutputFile(const std::string& path) : _path(path) {
+#if defined(__unix__) || defined(__APPLE__)
+		_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (_fd < 0)
+			throw Exception("Unable to create file: " + path);
+#else
+		_out.open(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!_out.is_open())
+			throw Exception("Unable to create file: " + path);
+#endif
+	}
+
+	~OutputFile() {
+#if defined(__unix__) || defined(__APPLE__)
+		if (_fd >= 0) ::close(_fd);
+#endif
+	}
+
+	OutputFile(const OutputFile&) = delete;
+	OutputFile& operator = (const OutputFile&) = delete;
+
+	// write the buffers one after another
+	void write(std::span<const std::string_view> buffers) {
+#if defined(__unix__) || defined(__APPLE__)
+		std::vector<iovec> vec;
+		for (const std::string_view& buffer : buffers)
+			if (!buffer.empty()) vec.push_back({ const_cast<char*>(buffer.data()), buffer.size() });
+
+		size_t first = 0;
+		while (first < vec.size()) {
+			int amount = static_cast<int>(std::min<size_t>(vec.size() - first, IOV_MAX));
+			ssize_t written = ::writev(_fd, vec.data() + first, amount);
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				throw Exception("Write error in file: " + _path);
+			}
+
+			// skip the written part, a short write leaves a partial buffer
+			size_t left = static_cast<size_t>(written);
+			while (first < vec.size() && left >= vec[first].iov_len) left -= vec[first++].iov_len;
+			if (left) {
+				vec[first].iov_base = static_cast<char*>(vec[first].iov_base) + left;
+				vec[first].iov_len -= left;
+			}
+		}
+#else
+		for (const std::string_view& buffer : buffers)
+			_out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		if (!_out)
+			throw Exception("Write error in file: " + _path);
+#endif
+	}
+
+	void write(std::string_view buffer) { write(std::span<const std::string_view>(&buffer, 1)); }
+
+	// flush and close, errors are reported here and not in the destructor
+	void close() {
+#if defined(__unix__) || defined(__APPLE__)
+		int code = ::close(_fd);
+		_fd = -1;
+		if (code != 0)
+			throw Exception("Write error in file: " + _path);
+#else
+		_out.close();
+		if (!_out)
+			throw Exception("Write error in file: " + _path);
+#endif
+	}
+
+private:
+	std::string _path;
+#if defined(__unix__) || defined(__APPLE__)
+	int _fd = -1;
+#else
+	std::ofstream _out;
+#endif
+};
+
+// append a number in its shortest exact form
+template <class T>
+void append(std::string& dest, T value) {
+	char buffer[32];
+	auto [end, code] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	dest.append(buffer, end);
+}
+
+// amount of chunks formatted at once
+size_t waveSize(const WriterOptions& options, ThreadPool& pool) {
+	return options._chunks ? options._chunks : pool.size();
+}
+
+// format items [0, count) into text chunks and write them in order,
+// a wave of chunks is formatted in parallel while memory stays bounded
+void writeChunked(OutputFile&                                         file,
+		  size_t                                              count,
+		  size_t                                              lineBytes,
+		  const WriterOptions&                                options,
+		  ThreadPool&                                         pool,
+		  const std::function<void(std::string&, size_t, size_t)>& format) {
+	size_t perChunk = std::max<size_t>(1, options._bufferSize / std::max<size_t>(1, lineBytes));
+	size_t wave = waveSize(options, pool);
+	std::vector<std::string> buffers(wave);
+	std::vector<std::string_view> views(wave);
+
+	for (size_t first = 0; first < count; first += perChunk * wave) {
+		size_t last = std::min(count, first + perChunk * wave);
+		size_t chunks = (last - first + perChunk - 1) / perChunk;
+
+		auto body = [&](size_t chunk, size_t, size_t) {
+			size_t begin = first + chunk * perChunk;
+			buffers[chunk].clear();
+			format(buffers[chunk], begin, std::min(last, begin + perChunk));
+			views[chunk] = buffers[chunk];
+		};
+		if (chunks == 1) body(0, 0, 1);
+		else pool.parallelFor(chunks, chunks, body);
+
+		file.write(std::span<const std::string_view>(views.data(), chunks));
+	}
+}
+
+// run body(begin, end) over [0, count) split into chunks
+void parallelFill(size_t count, const WriterOptions& options, ThreadPool& pool, const std::function<void(size_t, size_t)>& body) {
+	size_t chunks = waveSize(options, pool);
+	if (chunks <= 1 || count < 4096) body(0, count);
+	else pool.parallelFor(count, chunks, [&body](size_t, size_t begin, size_t end) { body(begin, end); });
+}
+
+// position of a node (0 based) for the formats with implicit node ids
+size_t nodePosition(const FrozenMesh& mesh, size_t id) {
+	size_t index = mesh.nodeIndex(id);
+	if (index == FrozenMesh::npos)
+		throw Exception("Node " + std::to_string(id) + " is not present in the loaded data");
+	return index;
+}
+
+// elements of a block must all have the same amount of nodes
+template <class Element>
+void checkArity(const std::vector<Element>& elements, size_t nodes) {
+	for (const Element& el : elements)
+		if (el._nodeIDvec.size() != nodes)
+			throw Exception("Element " + std::to_string(el._id) + " has " + std::to_string(el._nodeIDvec.size()) +
+					" nodes instead of " + std::to_string(nodes));
+}
+
+// value in big endian byte order (legacy VTK binary)
+template <class T>
+T bigEndian(T value) {
+	if constexpr (std::endian::native == std::endian::little) {
+		char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		std::reverse(bytes, bytes + sizeof(T));
+		std::memcpy(&value, bytes, sizeof(T));
+	}
+	return value;
+}
+
+// store a value at a byte position of a buffer
+template <class T>
+void store(std::span<char> dest, size_t offset, T value) {
+	std::memcpy(dest.data() + offset, &value, sizeof(T));
+}
+
+// VTK cell type of a linear or quadratic element by its shape and its amount of nodes
+uint8_t vtkCellType(ElementType type, size_t nodes) {
+	if (nodes == vertexCount(type)) {
+		switch (type) {
+		case ElementType::Segment: return 3;        // VTK_LINE
+		case ElementType::Triangle: return 5;       // VTK_TRIANGLE
+		case ElementType::Quadrilateral: return 9;  // VTK_QUAD
+		case ElementType::Tetrahedron: return 10;   // VTK_TETRA
+		case ElementType::Hexahedron: return 12;    // VTK_HEXAHEDRON
+		case ElementType::Prism: return 13;         // VTK_WEDGE
+		case ElementType::Pyramid: return 14;       // VTK_PYRAMID
+		default: break;
+		}
+	}
+	// quadratic simplices as made by newNodesInEdges
+	if (type == ElementType::Segment && nodes == 3) return 21;      // VTK_QUADRATIC_EDGE
+	if (type == ElementType::Triangle && nodes == 6) return 22;     // VTK_QUADRATIC_TRIANGLE
+	if (type == ElementType::Tetrahedron && nodes == 10) return 24; // VTK_QUADRATIC_TETRA
+	throw Exception("No VTK cell type for a " + std::string(elementTypeName(type)) + " element with " +
+			std::to_string(nodes) + " nodes");
+}
+
+// positions of the nodes of an element in VTK order (empty for the order of the element):
+// newNodesInEdges appends the midside nodes in the edge order 01 02 12 (03 13 23),
+// VTK expects 01 12 20 for the triangle and 01 12 20 03 13 23 for the tetrahedron
+std::span<const uint8_t> vtkNodeOrder(uint8_t cellType) {
+	static constexpr uint8_t quadraticTriangle[] = { 0, 1, 2, 3, 5, 4 };
+	static constexpr uint8_t quadraticTetrahedron[] = { 0, 1, 2, 3, 4, 7, 5, 6, 8, 9 };
+	switch (cellType) {
+	case 22: return quadraticTriangle;
+	case 24: return quadraticTetrahedron;
+	default: return {};
+	}
+}
+
+// cells written to the VTK output: finite elements, then optionally boundary elements,
+// the cell types come from the element buckets, so the shapes may be mixed
+struct VtkCells {
+	size_t _finite{};
+	size_t _boundary{};
+	std::vector<uint8_t> _types;
+	std::vector<size_t> _connectivity; // node references of the cells before i, size() + 1 values
+
+	VtkCells(const FrozenMesh& mesh, const WriterOptions& options) {
+		_finite = mesh.sizeFiniteElements();
+		_boundary = options._vtkBoundary ? mesh.sizeBoundaryElements() : 0;
+		_types.resize(size());
+		_connectivity.assign(size() + 1, 0);
+
+		auto fill = [this](const ElementBuckets& buckets, size_t first) {
+			for (const ElementBucket& bucket : buckets._buckets) {
+				uint8_t type = vtkCellType(bucket._type, bucket._arity);
+				for (const size_t& position : bucket._positions) {
+					_types[first + position] = type;
+					_connectivity[first + position + 1] = bucket._arity;
+				}
+			}
+		};
+		fill(mesh.finiteBuckets(), 0);
+		if (_boundary) fill(mesh.boundaryBuckets(), _finite);
+		std::partial_sum(begin(_connectivity), end(_connectivity), begin(_connectivity));
+	}
+
+	size_t size() const { return _finite + _boundary; }
+
+	// nodes of the cell i
+	const std::vector<size_t>& nodes(const FrozenMesh& mesh, size_t i) const {
+		return i < _finite ? mesh.getFiniteElements()[i]._nodeIDvec : mesh.getBoundaryElements()[i - _finite]._nodeIDvec;
+	}
+
+	// node j of the cell i in VTK order
+	size_t node(const std::vector<size_t>& ids, size_t i, size_t j) const {
+		std::span<const uint8_t> order = vtkNodeOrder(_types[i]);
+		return ids[order.empty() ? j : order[j]];
+	}
+
+	// material or surface area id of the cell i
+	size_t area(const FrozenMesh& mesh, size_t i) const {
+		return i < _finite ? mesh.getFiniteElements()[i]._material_area_id : mesh.getBoundaryElements()[i - _finite]._surface_area_id;
+	}
+
+	uint8_t type(size_t i) const { return _types[i]; }
+
+	// amount of node references of the cells before i
+	size_t connectivityBefore(size_t i) const { return _connectivity[i]; }
+};
+
+// offset rounded up for the aligned sections of the binary format
+uint64_t align64(uint64_t offset) { return (offset + 63) / 64 * 64; }
+
+// first bytes of the binary format
+constexpr char binaryMagic[8] = { 'A', 'N', 'E', 'U', 'B', 'I', 'N', '1' };
+
+// bytes used by section i of the binary format (without the padding)
+uint64_t sectionLength(const BinaryHeader& header, size_t i) {
+	switch (i) {
+	case 0: return header._nodes * 8;
+	case 1: return header._nodes * header._spaceDimension * 8;
+	case 2: return header._nodes;
+	case 3: case 4: return header._finiteElements * 8;
+	case 5: return header._finiteElements * header._nodesInFE * 8;
+	case 6: case 7: return header._boundaryElements * 8;
+	default: return header._boundaryElements * header._nodesInBE * 8;
+	}
+}
+
+// header of the binary image of a mesh with the section layout
+BinaryHeader binaryHeader(const FrozenMesh& mesh) {
+	BinaryHeader header{};
+	std::memcpy(header._magic, binaryMagic, sizeof(binaryMagic));
+	header._spaceDimension = mesh.spaceDim();
+	header._nodes = mesh.sizeNodes();
+	header._finiteElements = mesh.sizeFiniteElements();
+	header._nodesInFE = mesh.nodesInFE();
+	header._boundaryElements = mesh.sizeBoundaryElements();
+	header._nodesInBE = mesh.nodesInBE();
+
+	uint64_t offset = align64(sizeof(BinaryHeader));
+	for (size_t i = 0; i < 9; ++i) {
+		header._sections[i] = offset;
+		offset = align64(offset + sectionLength(header, i));
+	}
+	header._size = offset;
+	return header;
+}
+
+} // namespace
+
+// write a mesh as *.aneu (node and element ids are renumbered by position)
+void writeAneu(const FrozenMesh& mesh, const std::string& path, const WriterOptions& options, ThreadPool& pool) {
+	OutputFile file(path);
+	const std::string_view eol = options._crlf ? "\r\n" : "\n";
+
+	std::string header;
+	append(header, mesh.sizeNodes());
+	header += ' ';
+	append(header, mesh.spaceDim());
+	header += eol;
+	file.write(header);
+
+	const std::vector<Node>& nodes = mesh.getNodes();
+	writeChunked(file, nodes.size(), 24 * mesh.spaceDim() + 2, options, pool,
+		[&](std::string& dest, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				for (const double& coord : nodes[i]._coords) {
+					dest += ' ';
+					append(dest, coord);
+				}
+				dest += eol;
+			}
+		});
+
+	auto writeElements = [&](const auto& elements, size_t arity, auto areaId) {
+		std::string blockHeader;
+		append(blockHeader, elements.size());
+		blockHeader += ' ';
+		append(blockHeader, arity);
+		blockHeader += eol;
+		file.write(blockHeader);
+
+		writeChunked(file, elements.size(), 8 * (arity + 1) + 2, options, pool,
+			[&](std::string& dest, size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					append(dest, areaId(elements[i]));
+					for (const size_t& id : elements[i]._nodeIDvec) {
+						dest += ' ';
+						append(dest, nodePosition(mesh, id) + 1);
+					}
+					dest += eol;
+				}
+			});
+	};
+	writeElements(mesh.getFiniteElements(), mesh.nodesInFE(), [](const FiniteElement& el) { return el._material_area_id; });
+	writeElements(mesh.getBoundaryElements(), mesh.nodesInBE(), [](const BoundaryElement& el) { return el._surface_area_id; });
+
+	file.close();
+}
+
+// amount of bytes of the binary cache image of a mesh
+size_t binaryImageSize(const FrozenMesh& mesh) {
+	return static_cast<size_t>(binaryHeader(mesh)._size);
+}
+
+// write the binary cache image of a mesh into a buffer (ids are kept)
+void writeBinaryImage(const FrozenMesh& mesh, std::span<char> image, const WriterOptions& options, ThreadPool& pool) {
+	const std::vector<Node>& nodes = mesh.getNodes();
+	const std::vector<FiniteElement>& finite = mesh.getFiniteElements();
+	const std::vector<BoundaryElement>& boundary = mesh.getBoundaryElements();
+	checkArity(finite, mesh.nodesInFE());
+	checkArity(boundary, mesh.nodesInBE());
+
+	BinaryHeader header = binaryHeader(mesh);
+	if (image.size() < header._size)
+		throw Exception("Buffer of " + std::to_string(image.size()) + " bytes is too small for a binary image of " +
+				std::to_string(header._size) + " bytes");
+	const uint64_t* sections = header._sections;
+
+	// the padding is cleared, the sections are overwritten completely
+	std::memcpy(image.data(), &header, sizeof(header));
+	std::memset(image.data() + sizeof(header), 0, sections[0] - sizeof(header));
+	for (size_t i = 0; i < 9; ++i) {
+		uint64_t used = sections[i] + sectionLength(header, i);
+		uint64_t next = i + 1 < 9 ? sections[i + 1] : header._size;
+		std::memset(image.data() + used, 0, next - used);
+	}
+
+	parallelFill(nodes.size(), options, pool, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			store<uint64_t>(image, sections[0] + i * 8, nodes[i]._id);
+			for (size_t axis = 0; axis < mesh.spaceDim(); ++axis)
+				store<double>(image, sections[1] + (axis * nodes.size() + i) * 8,
+					      axis < nodes[i]._coords.size() ? nodes[i]._coords[axis] : 0.0);
+			store<uint8_t>(image, sections[2] + i, nodes[i]._is_vertex);
+		}
+	});
+
+	auto fillElements = [&](const auto& elements, size_t arity, const uint64_t* section, auto areaId) {
+		parallelFill(elements.size(), options, pool, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				store<uint64_t>(image, section[0] + i * 8, elements[i]._id);
+				store<uint64_t>(image, section[1] + i * 8, areaId(elements[i]));
+				for (size_t j = 0; j < arity; ++j)
+					store<uint64_t>(image, section[2] + (i * arity + j) * 8, elements[i]._nodeIDvec[j]);
+			}
+		});
+	};
+	fillElements(finite, mesh.nodesInFE(), sections + 3, [](const FiniteElement& el) { return el._material_area_id; });
+	fillElements(boundary, mesh.nodesInBE(), sections + 6, [](const BoundaryElement& el) { return el._surface_area_id; });
+}
+
+// write a mesh in the binary cache format (ids are kept)
+void writeBinary(const FrozenMesh& mesh, const std::string& path, const WriterOptions& options, ThreadPool& pool) {
+	std::string image(binaryImageSize(mesh), '\0');
+	writeBinaryImage(mesh, image, options, pool);
+
+	OutputFile file(path);
+	file.write(image);
+	file.close();
+}
+
+// check the header and the section bounds of an image
+BinaryMeshView BinaryMeshView::parse(const void* data, size_t size) {
+	if (size < sizeof(BinaryHeader) || reinterpret_cast<uintptr_t>(data) % 8 != 0)
+		throw Exception("Binary mesh image is too small or misaligned");
+
+	BinaryHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header._magic, binaryMagic, sizeof(binaryMagic)) != 0)
+		throw Exception("Not a binary mesh image (bad magic)");
+	if (header._size > size)
+		throw Exception("Binary mesh image is truncated");
+
+	const char* bytes = static_cast<const char*>(data);
+	auto section = [&]<class T>(size_t index, uint64_t amount, T*) {
+		uint64_t offset = header._sections[index];
+		if (offset % 8 != 0 || offset > header._size || amount > (header._size - offset) / sizeof(T))
+			throw Exception("Binary mesh image has a corrupted section " + std::to_string(index));
+		return std::span<const T>(reinterpret_cast<const T*>(bytes + offset), static_cast<size_t>(amount));
+	};
+
+	BinaryMeshView res{};
+	res._spaceDimension = static_cast<size_t>(header._spaceDimension);
+	res._nodesInFE = static_cast<size_t>(header._nodesInFE);
+	res._nodesInBE = static_cast<size_t>(header._nodesInBE);
+	res._nodeIds = section(0, header._nodes, static_cast<uint64_t*>(nullptr));
+	res._coords = section(1, header._nodes * header._spaceDimension, static_cast<double*>(nullptr));
+	res._isVertex = section(2, header._nodes, static_cast<uint8_t*>(nullptr));
+	res._finiteElementIds = section(3, header._finiteElements, static_cast<uint64_t*>(nullptr));
+	res._materialIds = section(4, header._finiteElements, static_cast<uint64_t*>(nullptr));
+	res._finiteElementNodes = section(5, header._finiteElements * header._nodesInFE, static_cast<uint64_t*>(nullptr));
+	res._boundaryElementIds = section(6, header._boundaryElements, static_cast<uint64_t*>(nullptr));
+	res._surfaceIds = section(7, header._boundaryElements, static_cast<uint64_t*>(nullptr));
+	res._boundaryElementNodes = section(8, header._boundaryElements * header._nodesInBE, static_cast<uint64_t*>(nullptr));
+	return res;
+}
+
+// read a file in the binary cache format
+BinaryMesh readBinary(const std::string& path) {
+	std::ifstream in(path, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+	if (!in.is_open())
+		throw Exception("Unable to open file at specified path: " + path);
+
+	size_t size = static_cast<size_t>(in.tellg());
+	BinaryMesh res{};
+	res._image.resize((size + 7) / 8);
+	in.seekg(0);
+	in.read(reinterpret_cast<char*>(res._image.data()), static_cast<std::streamsize>(size));
+	if (!in)
+		throw Exception("Read error in file: " + path);
+
+	res._view = BinaryMeshView::parse(res._image.data(), size);
+	return res;
+}
+
+// write the finite elements as a legacy binary VTK unstructured grid (*.vtk)
+void writeVtkLegacy(const FrozenMesh& mesh, const std::string& path, const WriterOptions& options, ThreadPool& pool) {
+	const std::vector<Node>& nodes = mesh.getNodes();
+	VtkCells cells(mesh, options);
+	size_t connectivity = cells.connectivityBefore(cells.size());
+
+	std::string header = "# vtk DataFile Version 3.0\nmesh\nBINARY\nDATASET UNSTRUCTURED_GRID\nPOINTS ";
+	append(header, nodes.size());
+	header += " double\n";
+
+	// points are always 3D
+	std::string points(nodes.size() * 3 * sizeof(double), '\0');
+	parallelFill(nodes.size(), options, pool, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			for (size_t axis = 0; axis < 3; ++axis)
+				store<double>(points, (i * 3 + axis) * sizeof(double),
+					      bigEndian(axis < nodes[i]._coords.size() ? nodes[i]._coords[axis] : 0.0));
+	});
+
+	std::string cellsHeader = "\nCELLS ";
+	append(cellsHeader, cells.size());
+	cellsHeader += ' ';
+	append(cellsHeader, connectivity + cells.size());
+	cellsHeader += '\n';
+
+	// every cell is its amount of nodes followed by the node positions
+	std::string cellData((connectivity + cells.size()) * sizeof(int32_t), '\0');
+	std::string types(cells.size() * sizeof(int32_t), '\0');
+	std::string areas(cells.size() * sizeof(int32_t), '\0');
+	parallelFill(cells.size(), options, pool, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			const std::vector<size_t>& ids = cells.nodes(mesh, i);
+			size_t at = (cells.connectivityBefore(i) + i) * sizeof(int32_t);
+			store<int32_t>(cellData, at, bigEndian(static_cast<int32_t>(ids.size())));
+			for (size_t j = 0; j < ids.size(); ++j)
+				store<int32_t>(cellData, at + (j + 1) * sizeof(int32_t),
+					       bigEndian(static_cast<int32_t>(nodePosition(mesh, cells.node(ids, i, j)))));
+			store<int32_t>(types, i * sizeof(int32_t), bigEndian(static_cast<int32_t>(cells.type(i))));
+			store<int32_t>(areas, i * sizeof(int32_t), bigEndian(static_cast<int32_t>(cells.area(mesh, i))));
+		}
+	});
+
+	std::string typesHeader = "\nCELL_TYPES ";
+	append(typesHeader, cells.size());
+	typesHeader += '\n';
+
+	std::string areasHeader = "\nCELL_DATA ";
+	append(areasHeader, cells.size());
+	areasHeader += "\nSCALARS area int 1\nLOOKUP_TABLE default\n";
+
+	const std::string_view buffers[] = { header, points, cellsHeader, cellData, typesHeader, types, areasHeader, areas, "\n" };
+	OutputFile file(path);
+	file.write(buffers);
+	file.close();
+}
+
+// write the finite elements as an XML VTK unstructured grid with raw appended data (*.vtu)
+void writeVtu(const FrozenMesh& mesh, const std::string& path, const WriterOptions& options, ThreadPool& pool) {
+	const std::vector<Node>& nodes = mesh.getNodes();
+	VtkCells cells(mesh, options);
+	size_t connectivity = cells.connectivityBefore(cells.size());
+
+	// every appended block starts with its size in bytes
+	auto block = [](size_t bytes) {
+		std::string res(sizeof(uint64_t) + bytes, '\0');
+		store<uint64_t>(res, 0, bytes);
+		return res;
+	};
+	std::string points = block(nodes.size() * 3 * sizeof(double));
+	std::string cellNodes = block(connectivity * sizeof(int64_t));
+	std::string offsets = block(cells.size() * sizeof(int64_t));
+	std::string types = block(cells.size());
+	std::string areas = block(cells.size() * sizeof(int64_t));
+
+	parallelFill(nodes.size(), options, pool, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			for (size_t axis = 0; axis < 3; ++axis)
+				store<double>(points, 8 + (i * 3 + axis) * sizeof(double),
+					      axis < nodes[i]._coords.size() ? nodes[i]._coords[axis] : 0.0);
+	});
+
+	parallelFill(cells.size(), options, pool, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			const std::vector<size_t>& ids = cells.nodes(mesh, i);
+			size_t first = cells.connectivityBefore(i);
+			for (size_t j = 0; j < ids.size(); ++j)
+				store<int64_t>(cellNodes, 8 + (first + j) * sizeof(int64_t), static_cast<int64_t>(nodePosition(mesh, cells.node(ids, i, j))));
+			store<int64_t>(offsets, 8 + i * sizeof(int64_t), static_cast<int64_t>(first + ids.size()));
+			store<uint8_t>(types, 8 + i, cells.type(i));
+			store<int64_t>(areas, 8 + i * sizeof(int64_t), static_cast<int64_t>(cells.area(mesh, i)));
+		}
+	});
+
+	size_t offset = 0;
+	auto array = [&offset](std::string& xml, const std::string& attributes, const std::string& data) {
+		xml += "        <DataArray " + attributes + " format=\"appended\" offset=\"";
+		append(xml, offset);
+		xml += "\"/>\n";
+		offset += data.size();
+	};
+
+	std::string xml = "<?xml version=\"1.0\"?>\n<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"";
+	xml += std::endian::native == std::endian::little ? "LittleEndian" : "BigEndian";
+	xml += "\" header_type=\"UInt64\">\n  <UnstructuredGrid>\n    <Piece NumberOfPoints=\"";
+	append(xml, nodes.size());
+	xml += "\" NumberOfCells=\"";
+	append(xml, cells.size());
+	xml += "\">\n      <Points>\n";
+	array(xml, "type=\"Float64\" NumberOfComponents=\"3\"", points);
+	xml += "      </Points>\n      <Cells>\n";
+	array(xml, "type=\"Int64\" Name=\"connectivity\"", cellNodes);
+	array(xml, "type=\"Int64\" Name=\"offsets\"", offsets);
+	array(xml, "type=\"UInt8\" Name=\"types\"", types);
+	xml += "      </Cells>\n      <CellData Scalars=\"area\">\n";
+	array(xml, "type=\"Int64\" Name=\"area\"", areas);
+	xml += "      </CellData>\n    </Piece>\n  </UnstructuredGrid>\n  <AppendedData encoding=\"raw\">\n   _";
+
+	const std::string_view buffers[] = { xml, points, cellNodes, offsets, types, areas, "\n  </AppendedData>\n</VTKFile>\n" };
+	OutputFile file(path);
+	file.write(buffers);
+	file.close();
+}
@@ -1,5 +1,17 @@
-#include "Mesh.h"
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+
 #include "Builder.h"
+#include "Geometry.h"
+#include "Mesh.h"
+#include "MeshHash.h"
+#include "MeshServer.h"
+#include "Writer.h"
 
 //auto main(int argc, char** argv) -> int {
 //	AneuMeshLoader obj;
@@ -96,12 +108,461 @@
 //	return 0;
 //}
 
-int main(int argc, char** argv) {
-    std::shared_ptr<GatherDataDirector> gdDirector(new GatherDataDirector());
-    std::shared_ptr<StatsDirector> sDirector( new StatsDirector());
+namespace {
+
+constexpr const char* usage = R"(usage: mesh <command> [options]
+
+commands:
+  stats <mesh> [--stats=areas,nodes,common,quality] [--format=text|json]
+  convert <mesh> <output> [--boundary] [--lf]
+      the output type follows its extension: .aneu, .bin, .vtk or .vtu
+  refine <mesh> <output> [--mode=uniform|marked|midpoint] [--levels=N] [--marked=<file>]
+      uniform: red refinement levels times, marked: adaptive refinement of the
+      element ids listed in the file, midpoint: a node in the middle of every edge
+  query <mesh> <file>
+      one query per line: 2 node ids (edge) or 3 vertex node ids
+  bench <mesh> [--repeat=N]
+  serve <socket> [<mesh>...] [--shm-prefix=/name]
+      load meshes once into shared memory and answer queries on a Unix socket
+      until SHUTDOWN, SIGINT or SIGTERM (the meshes listed are loaded up front)
+  ask <socket> <request...>
+      send one request to a server, e.g. ask /tmp/mesh.sock EDGE 1 2 /data/a.aneu
+      (ATTACH, EDGE, FACE, MATERIAL, AREA, AREANODES, NEIGHBOURS, STATS, LIST, SHUTDOWN)
+  help
+
+options of every command:
+  --threads=N   workers of the shared thread pool (0 = all cores)
+  --validate    check the mesh while loading, the report goes to stderr
+  --mixed       allow elements with different amounts of nodes in one block
+  --quiet       no timings on stderr
+
+<mesh> is *.aneu or *.neu (also .gz / .zst), convert and query take a *.bin cache too
+)";
+
+// wrong command line, main prints the usage hint for it
+class UsageError : public Exception {
+public:
+    using Exception::Exception;
+};
+
+bool endsWith(const std::string& text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// command line after the command: positional arguments and --name[=value] options
+class Arguments {
+public:
+    // constructor (argv[first] is the first argument after the command)
+    Arguments(int argc, char** argv, int first) {
+        for (int i = first; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (!arg.starts_with("--")) {
+                _positional.push_back(arg);
+                continue;
+            }
+            size_t equals = arg.find('=');
+            if (equals == std::string::npos) _options[arg.substr(2)] = "";
+            else _options[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+        }
+    }
+
+    // throw for options that are neither common nor in the list
+    void allow(std::initializer_list<const char*> names) const {
+        for (const auto& [name, value] : _options) {
+            bool known = name == "threads" || name == "validate" || name == "mixed" || name == "quiet";
+            for (const char* allowed : names) known = known || name == allowed;
+            if (!known) throw UsageError("Unknown option --" + name);
+        }
+    }
+
+    // positional argument i (UsageError with its name if it is missing)
+    const std::string& positional(size_t i, const char* name) const {
+        if (i >= _positional.size()) throw UsageError(std::string("Missing argument <") + name + ">");
+        return _positional[i];
+    }
+
+    size_t positionals() const { return _positional.size(); }
+
+    bool has(const std::string& name) const { return _options.contains(name); }
+
+    std::string text(const std::string& name, const std::string& fallback) const {
+        auto it = _options.find(name);
+        return it == end(_options) ? fallback : it->second;
+    }
+
+    size_t number(const std::string& name, size_t fallback) const {
+        auto it = _options.find(name);
+        if (it == end(_options)) return fallback;
+        size_t res{};
+        auto [last, ec] = std::from_chars(it->second.data(), it->second.data() + it->second.size(), res);
+        if (ec != std::errc() || last != it->second.data() + it->second.size())
+            throw UsageError("--" + name + " needs a number, got '" + it->second + "'");
+        return res;
+    }
+
+private:
+    std::vector<std::string> _positional;
+    std::map<std::string, std::string> _options;
+};
+
+// wall time of the steps of a command, reported on stderr as they finish
+class Timings {
+public:
+    explicit Timings(bool report) : _report(report) {}
+
+    // run a step and record its time in milliseconds
+    template <class Step>
+    void measure(const std::string& name, Step step) {
+        auto start = std::chrono::steady_clock::now();
+        step();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        _steps.emplace_back(name, ms);
+        if (_report) std::cerr << "time " << name << ": " << ms << " ms" << std::endl;
+    }
+
+    // recorded steps in the order they ran
+    const std::vector<std::pair<std::string, double>>& steps() const { return _steps; }
+
+    // sum of the recorded steps
+    double total() const {
+        double res = 0;
+        for (const auto& step : _steps) res += step.second;
+        return res;
+    }
 
-    ClientCode(*gdDirector, argv[1], *sDirector);
-    // delete gdDirector;
-    // delete sDirector;
+private:
+    bool _report;
+    std::vector<std::pair<std::string, double>> _steps;
+};
+
+// load a *.neu or *.aneu file with the common options
+std::unique_ptr<AneuMeshLoader> loadMesh(const std::string& path, const Arguments& args, Timings& timings) {
+    if (endsWith(path, ".bin")) throw UsageError("This command doesn't take a binary cache: " + path);
+
+    LoadOptions options{};
+    options._validate = args.has("validate");
+    options._mixedElements = args.has("mixed");
+
+    std::shared_ptr<GatherDataBuilder> builder;
+    if (isNeuPath(path)) builder.reset(new GatherDataBuilderNeu({}, options));
+    else builder.reset(new GatherDataBuilderAneu({}, options));
+
+    GatherDataDirector director;
+    director.set_builder(builder);
+    timings.measure("load", [&] { director.GatherData(path); });
+
+    std::unique_ptr<AneuMeshLoader> res = builder->Release();
+    if (options._validate) res->getValidationReport().print(std::cerr);
+    return res;
+}
+
+// snapshot of a mesh file, *.bin through the binary cache reader
+std::unique_ptr<FrozenMesh> loadFrozen(const std::string& path, const Arguments& args, Timings& timings) {
+    std::unique_ptr<FrozenMesh> res;
+    if (endsWith(path, ".bin")) {
+        timings.measure("load", [&] {
+            BinaryMesh image = readBinary(path);
+            res = std::make_unique<FrozenMesh>(image._view);
+        });
+        return res;
+    }
+
+    std::unique_ptr<AneuMeshLoader> mesh = loadMesh(path, args, timings);
+    timings.measure("freeze", [&] { res = std::make_unique<FrozenMesh>(*mesh); });
+    return res;
+}
+
+// writer for the extension of an output path (UsageError for unknown ones)
+std::function<void(const FrozenMesh&, const std::string&, const WriterOptions&)> writerFor(const std::string& path) {
+    if (endsWith(path, ".aneu")) return [](const FrozenMesh& mesh, const std::string& out, const WriterOptions& options) { writeAneu(mesh, out, options); };
+    if (endsWith(path, ".bin")) return [](const FrozenMesh& mesh, const std::string& out, const WriterOptions& options) { writeBinary(mesh, out, options); };
+    if (endsWith(path, ".vtk")) return [](const FrozenMesh& mesh, const std::string& out, const WriterOptions& options) { writeVtkLegacy(mesh, out, options); };
+    if (endsWith(path, ".vtu")) return [](const FrozenMesh& mesh, const std::string& out, const WriterOptions& options) { writeVtu(mesh, out, options); };
+    throw UsageError("Unknown output type (expected .aneu, .bin, .vtk or .vtu): " + path);
+}
+
+// writer settings from the options of convert and refine
+WriterOptions writerOptions(const Arguments& args) {
+    WriterOptions res{};
+    res._crlf = !args.has("lf");
+    res._vtkBoundary = args.has("boundary");
+    return res;
+}
+
+// mesh sizes for the summaries on stdout
+template <class Mesh>
+std::string sizes(const Mesh& mesh) {
+    return std::to_string(mesh.sizeNodes()) + " nodes, " + std::to_string(mesh.sizeFiniteElements()) +
+           " finite elements, " + std::to_string(mesh.sizeBoundaryElements()) + " boundary elements";
+}
+
+int runStats(const Arguments& args, Timings& timings) {
+    args.allow({ "stats", "format" });
+    std::string format = args.text("format", "text");
+    if (format != "text" && format != "json") throw UsageError("Unknown format '" + format + "' (text or json)");
+
+    std::set<std::string> parts;
+    std::string list = args.text("stats", "all");
+    for (size_t begin = 0; begin <= list.size();) {
+        size_t end = std::min(list.find(',', begin), list.size());
+        std::string part = list.substr(begin, end - begin);
+        if (part == "all") parts.insert({ "areas", "nodes", "common", "quality" });
+        else if (part == "areas" || part == "nodes" || part == "common" || part == "quality") parts.insert(part);
+        else throw UsageError("Unknown statistic '" + part + "' (areas, nodes, common, quality or all)");
+        begin = end + 1;
+    }
+
+    std::unique_ptr<AneuMeshLoader> mesh = loadMesh(args.positional(0, "mesh"), args, timings);
+
+    std::shared_ptr<StatsBuilder> builder(new StatsBuilder());
+    StatsDirector director;
+    director.set_builder(builder);
+    timings.measure("stats", [&] {
+        // everything at once shares the traversals of the finite elements
+        if (parts.size() == 4) {
+            director.CountAllStatisticsWithQuality(*mesh);
+            return;
+        }
+        if (parts.contains("areas")) director.CountAmountOfElementsByAreaId(*mesh);
+        if (parts.contains("nodes")) director.CountNodesInElements(*mesh);
+        if (parts.contains("common")) director.CountCommonNodesInElements(*mesh);
+        if (parts.contains("quality")) director.CountMeshQuality(*mesh);
+    });
+
+    std::shared_ptr<Statistics> stats = builder->GetStat();
+    if (format == "json") stats->WriteJson(std::cout);
+    else stats->ShowData();
     return 0;
 }
+
+int runConvert(const Arguments& args, Timings& timings) {
+    args.allow({ "boundary", "lf" });
+    const std::string& output = args.positional(1, "output");
+    auto write = writerFor(output);
+
+    std::unique_ptr<FrozenMesh> mesh = loadFrozen(args.positional(0, "mesh"), args, timings);
+    timings.measure("write", [&] { write(*mesh, output, writerOptions(args)); });
+    std::cout << output << ": " << sizes(*mesh) << std::endl;
+    return 0;
+}
+
+int runRefine(const Arguments& args, Timings& timings) {
+    args.allow({ "mode", "levels", "marked", "boundary", "lf" });
+    std::string mode = args.text("mode", args.has("marked") ? "marked" : "uniform");
+    if (mode != "uniform" && mode != "marked" && mode != "midpoint")
+        throw UsageError("Unknown refinement mode '" + mode + "' (uniform, marked or midpoint)");
+    size_t levels = args.number("levels", 1);
+
+    std::unordered_set<size_t> marked;
+    if (mode == "marked") {
+        std::string path = args.text("marked", "");
+        if (path.empty()) throw UsageError("--mode=marked needs --marked=<file with element ids>");
+        std::ifstream in(path);
+        if (!in.is_open()) throw Exception("Unable to open file at specified path: " + path);
+        for (size_t id; in >> id;) marked.insert(id);
+        if (!in.eof()) throw Exception("Malformed element id in " + path);
+    }
+
+    const std::string& output = args.positional(1, "output");
+    auto write = writerFor(output);
+
+    std::unique_ptr<AneuMeshLoader> mesh = loadMesh(args.positional(0, "mesh"), args, timings);
+    std::string before = sizes(*mesh);
+    timings.measure("refine", [&] {
+        if (mode == "uniform") mesh->refineUniform(levels);
+        else if (mode == "marked") mesh->refineMarked(marked);
+        else mesh->newNodesInEdges();
+    });
+
+    std::unique_ptr<FrozenMesh> frozen;
+    timings.measure("freeze", [&] { frozen = std::make_unique<FrozenMesh>(*mesh); });
+    timings.measure("write", [&] { write(*frozen, output, writerOptions(args)); });
+    std::cout << before << " -> " << sizes(*frozen) << std::endl;
+    return 0;
+}
+
+int runQuery(const Arguments& args, Timings& timings) {
+    args.allow({});
+    const std::string& path = args.positional(1, "file");
+    std::ifstream in(path);
+    if (!in.is_open()) throw Exception("Unable to open file at specified path: " + path);
+
+    // queries are batched by kind, order[i] = {kind, index in its batch}
+    std::vector<std::array<size_t, 2>> edges;
+    std::vector<std::array<size_t, 3>> faces;
+    std::vector<std::pair<size_t, size_t>> order;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(in, line); ++lineNumber) {
+        std::istringstream fields(line);
+        std::vector<size_t> ids;
+        for (size_t id; fields >> id;) ids.push_back(id);
+        if (!fields.eof()) throw Exception(path + ":" + std::to_string(lineNumber) + ": malformed node id");
+        if (ids.empty()) continue;
+
+        if (ids.size() == 2) {
+            order.emplace_back(2, edges.size());
+            edges.push_back({ ids[0], ids[1] });
+        }
+        else if (ids.size() == 3) {
+            order.emplace_back(3, faces.size());
+            faces.push_back({ ids[0], ids[1], ids[2] });
+        }
+        else throw Exception(path + ":" + std::to_string(lineNumber) + ": a query has 2 or 3 node ids");
+    }
+
+    std::unique_ptr<FrozenMesh> mesh = loadFrozen(args.positional(0, "mesh"), args, timings);
+    timings.measure("index", [&] { if (mesh->sizeNodes()) mesh->elementsOfNode(0); });
+
+    QueryBatchResult edgeResult, faceResult;
+    timings.measure("query", [&] {
+        mesh->findFiniteElementsByEdges(edges, edgeResult);
+        mesh->findFiniteElementsByVertices(faces, faceResult);
+    });
+
+    std::string out;
+    for (const auto& [kind, i] : order) {
+        if (kind == 2) out += std::to_string(edges[i][0]) + " " + std::to_string(edges[i][1]) + ":";
+        else out += std::to_string(faces[i][0]) + " " + std::to_string(faces[i][1]) + " " + std::to_string(faces[i][2]) + ":";
+        for (const size_t& id : kind == 2 ? edgeResult[i] : faceResult[i]) out += " " + std::to_string(id);
+        out += '\n';
+    }
+    std::cout << out << std::flush;
+    return 0;
+}
+
+int runBench(const Arguments& args, Timings& timings) {
+    args.allow({ "repeat" });
+    size_t repeat = std::max<size_t>(args.number("repeat", 3), 1);
+    const std::string& path = args.positional(0, "mesh");
+
+    // every round runs the whole pipeline on a fresh mesh
+    std::vector<std::pair<std::string, std::vector<double>>> samples;
+    for (size_t round = 1; round <= repeat; ++round) {
+        Timings steps(false);
+        timings.measure("round " + std::to_string(round), [&] {
+            std::unique_ptr<AneuMeshLoader> mesh = loadMesh(path, args, steps);
+
+            std::unique_ptr<FrozenMesh> frozen;
+            steps.measure("freeze", [&] { frozen = std::make_unique<FrozenMesh>(*mesh); });
+            steps.measure("geometry", [&] { computeGeometry(*frozen); });
+            steps.measure("stats", [&] {
+                std::shared_ptr<StatsBuilder> builder(new StatsBuilder());
+                StatsDirector director;
+                director.set_builder(builder);
+                director.CountAllStatisticsWithQuality(*mesh);
+            });
+
+            // one edge query per finite element
+            std::vector<std::array<size_t, 2>> edges;
+            for (const FiniteElement& el : frozen->getFiniteElements())
+                if (el._nodeIDvec.size() >= 2) edges.push_back({ el._nodeIDvec[0], el._nodeIDvec[1] });
+            QueryBatchResult result;
+            steps.measure("query", [&] { frozen->findFiniteElementsByEdges(edges, result); });
+            steps.measure("hash", [&] { hashMesh(*frozen); });
+
+            if (round == 1) std::cout << path << ": " << sizes(*frozen) << std::endl;
+        });
+
+        if (samples.empty())
+            for (const auto& step : steps.steps()) samples.emplace_back(step.first, std::vector<double>{});
+        for (size_t i = 0; i < samples.size(); ++i) samples[i].second.push_back(steps.steps()[i].second);
+    }
+
+    std::cout << std::left << std::setw(10) << "step" << std::right << std::setw(12) << "min ms"
+              << std::setw(12) << "mean ms" << std::setw(12) << "max ms" << std::endl;
+    for (const auto& [name, values] : samples) {
+        double mean = std::accumulate(begin(values), end(values), 0.0) / static_cast<double>(values.size());
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << *std::ranges::min_element(values) << std::setw(12) << mean
+                  << std::setw(12) << *std::ranges::max_element(values) << std::defaultfloat << std::endl;
+    }
+    return 0;
+}
+
+// server stopped by SIGINT / SIGTERM, so its shared memory objects are removed
+MeshServer* serving = nullptr;
+
+extern "C" void stopServing(int) {
+    if (serving) serving->stop();
+}
+
+int runServe(const Arguments& args, Timings& timings) {
+    args.allow({ "shm-prefix" });
+    MeshServerOptions options{};
+    options._socketPath = args.positional(0, "socket");
+    options._sharedPrefix = args.text("shm-prefix", options._sharedPrefix);
+    options._load._mixedElements = args.has("mixed");
+
+    MeshServer server(options);
+    for (size_t i = 1; i < args.positionals(); ++i) {
+        const std::string& path = args.positional(i, "mesh");
+        std::string name;
+        timings.measure("load " + path, [&] { name = server.preload(path); });
+        std::cout << path << " -> " << name << std::endl;
+    }
+
+    serving = &server;
+    std::signal(SIGINT, stopServing);
+    std::signal(SIGTERM, stopServing);
+    std::cout << "serving on " << options._socketPath << std::endl;
+    server.run();
+    serving = nullptr;
+    return 0;
+}
+
+int runAsk(const Arguments& args, Timings&) {
+    args.allow({});
+    MeshClient client(args.positional(0, "socket"));
+    std::string request = args.positional(1, "request");
+    for (size_t i = 2; i < args.positionals(); ++i) request += " " + args.positional(i, "request");
+    std::cout << client.request(request) << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << usage;
+        return 2;
+    }
+
+    std::string command = argv[1];
+    if (command == "help" || command == "--help" || command == "-h") {
+        std::cout << usage;
+        return 0;
+    }
+
+    std::map<std::string, int (*)(const Arguments&, Timings&)> commands{
+        { "stats", runStats }, { "convert", runConvert }, { "refine", runRefine }, { "query", runQuery }, { "bench", runBench },
+        { "serve", runServe }, { "ask", runAsk }
+    };
+
+    try {
+        // a lone file path prints all of the statistics like before the subcommands
+        auto run = commands.find(command);
+        if (run == end(commands) && argc == 2 && !command.starts_with("-")) {
+            std::shared_ptr<GatherDataDirector> gdDirector(new GatherDataDirector());
+            std::shared_ptr<StatsDirector> sDirector(new StatsDirector());
+            ClientCode(*gdDirector, command, *sDirector);
+            return 0;
+        }
+        if (run == end(commands)) throw UsageError("Unknown command '" + command + "'");
+
+        Arguments args(argc, argv, 2);
+        ThreadPool::configureShared(args.number("threads", 0));
+
+        Timings timings(!args.has("quiet"));
+        int res = run->second(args, timings);
+        if (!args.has("quiet")) std::cerr << "time total: " << timings.total() << " ms" << std::endl;
+        return res;
+    }
+    catch (const UsageError& e) {
+        std::cerr << "mesh: " << e.what() << "\n(run 'mesh help' for the usage)" << std::endl;
+        return 2;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "mesh: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,107 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "Builder.h"
+
+// regression test for the copies made while loading a mesh through the builder pipeline:
+// every loaded node and element may cost its coordinate / node id vector and its hash table node,
+// nothing else, so a copy of a Node, a FiniteElement or a BoundaryElement (each owns a vector)
+// shows up as at least one more heap allocation per loaded entity
+//
+// built from this file and the library sources (Resource Files/*.cpp) without the main of
+// Source Files, run from the repository root:
+//   LoadAllocations [<mesh.neu or mesh.aneu>]   (donut.neu by default, its *.aneu is measured)
+// the exit code is 0 if the budget is kept, 1 otherwise
+
+namespace {
+
+// allocations are counted only while a measured load runs
+std::atomic<size_t> allocations{ 0 };
+std::atomic<bool> counting{ false };
+
+} // namespace
+
+// the replaced allocation functions come in matching pairs: every form of new and delete,
+// scalar and array, sized and unsized, goes through the same malloc / free
+void* operator new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* res = std::malloc(size ? size : 1)) return res;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+// gcc inlines this delete after a new-expression, sees free() applied to the result of operator new
+// and raises -Wmismatched-new-delete, although the pointer comes from the malloc above
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+
+void operator delete[](void* pointer, size_t) noexcept { operator delete(pointer); }
+
+namespace {
+
+// allocations allowed per loaded node or element
+constexpr size_t allocationsPerEntity = 2;
+
+// allocations independent of the size of the mesh (file buffers, the reserved tables, a new loader for Reset)
+constexpr size_t fixedAllocations = 64;
+
+// load a file through its builder and hand the mesh over, the way the pipeline does
+std::unique_ptr<AneuMeshLoader> load(const std::string& path) {
+    std::shared_ptr<GatherDataBuilder> builder;
+    if (isNeuPath(path)) builder.reset(new GatherDataBuilderNeu());
+    else builder.reset(new GatherDataBuilderAneu());
+
+    GatherDataDirector director;
+    director.set_builder(builder);
+    director.GatherData(path);
+    return builder->Release();
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    std::string path = argc > 1 ? argv[1] : "donut.neu";
+
+    try {
+        // the first load writes the *.aneu of a *.neu file and starts the shared pool,
+        // the measured one reads the *.aneu
+        load(path);
+        if (isNeuPath(path)) path = AneuMeshLoader::NeuToAneuPath(path);
+
+        counting = true;
+        std::unique_ptr<AneuMeshLoader> mesh = load(path);
+        counting = false;
+
+        size_t entities = mesh->sizeNodes() + mesh->sizeFiniteElements() + mesh->sizeBoundaryElements();
+        size_t budget = entities * allocationsPerEntity + fixedAllocations;
+        std::cout << path << ": " << entities << " entities, " << allocations << " allocations ("
+                  << static_cast<double>(allocations) / static_cast<double>(entities) << " per entity, budget "
+                  << budget << ")" << std::endl;
+
+        if (allocations > budget) {
+            std::cout << "FAILED: loading makes more than " << allocationsPerEntity
+                      << " allocations per entity, a node or an element is copied" << std::endl;
+            return 1;
+        }
+        std::cout << "OK" << std::endl;
+        return 0;
+    }
+    catch (const Exception& e) {
+        counting = false;
+        std::cout << "FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+}